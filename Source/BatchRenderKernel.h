@@ -0,0 +1,94 @@
+/*
+  ==============================================================================
+
+    BatchRenderKernel.h
+    Created: 23 Oct 2026 10:14:42am
+    Author:  Ekaterina Poklonskaya
+
+    The BatchReverberator render loop. There is no include guard on purpose:
+    every DspKernels*.cpp includes it inside its own namespace, so every
+    instruction set gets its own copy of the code and nothing is shared between them.
+
+  ==============================================================================
+*/
+
+template <int lanes>
+static int renderLanes(const BatchState& state, const float* const* inputs, float* const* wetOutputs, unsigned blockLength)
+{
+    // the lane loops have a compile-time trip count, so the compiler turns each of them into vector instructions
+    const int N = state.dimension;
+    const int numLanes = state.numLanes;
+    const int delayDepth = state.delayDepth;
+    const size_t lineStride = (size_t)delayDepth * lanes;
+    float* delayMemory = state.delayMemory;
+    int delayIdx = state.delayIdx;
+
+    float input[lanes] = {};
+    float output[lanes];
+    float taps[MaxDimension * lanes];
+
+    for (unsigned n = 0; n < blockLength; ++n)
+    {
+        for (auto k = 0; k < numLanes; ++k)
+            input[k] = inputs[k][n];
+
+        for (auto k = 0; k < lanes; ++k)
+            output[k] = input[k];
+
+        for (auto i = 0; i < N; ++i)
+        {
+            auto delayedIdx = delayIdx - state.delayValues[i];
+            if (delayedIdx < 0)
+                delayedIdx += delayDepth;
+            const float* tap = &delayMemory[i * lineStride + (size_t)delayedIdx * lanes];
+            for (auto k = 0; k < lanes; ++k)
+            {
+                taps[i * lanes + k] = tap[k];
+                output[k] += state.cValue * tap[k];
+            }
+        }
+
+        // see FeedbackRotation::Apply()
+        for (auto pair = 0; pair < state.numRotationPairs; ++pair)
+        {
+            auto c = state.rotationCos[pair];
+            auto s = state.rotationSin[pair];
+            float* a = taps + 2 * pair * lanes;
+            float* b = a + lanes;
+            for (auto k = 0; k < lanes; ++k)
+            {
+                auto rotatedA = c * a[k] - s * b[k];
+                b[k] = s * a[k] + c * b[k];
+                a[k] = rotatedA;
+            }
+        }
+
+        for (auto i = 0; i < N; ++i)
+        {
+            float dotMultiplication[lanes] = {};
+            for (auto j = 0; j < N; ++j)
+            {
+                auto coefficient = state.mixingMatrix[i * N + j];
+                for (auto k = 0; k < lanes; ++k)
+                    dotMultiplication[k] += taps[j * lanes + k] * coefficient;
+            }
+            float* frame = &delayMemory[i * lineStride + (size_t)delayIdx * lanes];
+            const auto lineGain = state.lineGains[i];
+            for (auto k = 0; k < lanes; ++k)
+                frame[k] = input[k] * state.bValue + lineGain * dotMultiplication[k];
+        }
+
+        for (auto k = 0; k < numLanes; ++k)
+            wetOutputs[k][n] = output[k] / (float)N; //trying to prevent overdrive, heuristics...
+
+        if (++delayIdx == delayDepth)
+            delayIdx = 0;
+    }
+    return delayIdx;
+}
+
+static const KernelTable kernelTable =
+{
+    level,
+    { renderLanes<1>, renderLanes<2>, renderLanes<4>, renderLanes<8> }
+};
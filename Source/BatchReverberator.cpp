@@ -0,0 +1,164 @@
+/*
+  ==============================================================================
+
+    BatchReverberator.cpp
+    Created: 19 Oct 2026 10:12:05am
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#include "BatchReverberator.h"
+
+static int roundUpToPowerOfTwo(int value)
+{
+    int result = 1;
+    while (result < value)
+        result *= 2;
+    return result;
+}
+
+BatchReverberator::BatchReverberator(Reverberator::FdnDimension dim, const std::vector<int>& powers, int numLanes, int firstPrime) :
+        dimension(dim),
+        numLanes(numLanes),
+        laneStride(roundUpToPowerOfTwo(numLanes)),
+        firstPrime(firstPrime),
+        kernels(DspKernels::getKernels())
+{
+    jassert(numLanes > 0 && numLanes <= MaxLanes);
+    SetDimension(dim);
+    GenerateDelayValues(powers);
+}
+
+void BatchReverberator::Prepare(double sampleRate, int maxBlockSize)
+{
+    this->maxBlockSize = maxBlockSize;
+    UpdateDelayLines(delayValues.back());
+    rotation.Reset();
+    SetDecayTime(decayTime, sampleRate);
+}
+
+void BatchReverberator::GenerateDelayValues(const std::vector<int>& powers)
+{
+    delayValues = Reverberator::CalculateDelayValues(powers, firstPrime);
+    if (maxBlockSize > 0)
+        UpdateDelayLines(delayValues.back());
+    Reverberator::CalculateDecayGains(delayValues, decayTime, decaySampleRate, decayGains);
+    UpdateLineGains();
+}
+
+void BatchReverberator::UpdateDelayLines(int maxDelayLength)
+{
+    // the memory keeps its capacity, it is reallocated only when the new delays do not fit
+    delayDepth = maxDelayLength;
+    auto requiredSize = (size_t)dimension * delayDepth * laneStride;
+    if (requiredSize > delayMemory.capacity())
+        std::vector<float>(requiredSize, 0.f).swap(delayMemory);
+    else
+        delayMemory.resize(requiredSize);
+    ClearReadRegions();
+    delayIdx = 0;
+}
+
+void BatchReverberator::ClearReadRegions()
+{
+    // see Reverberator::ClearReadRegions(), only the last delayValues[i] frames of every line are read before written
+    const size_t lineStride = (size_t)delayDepth * laneStride;
+    for (auto i = 0; i < std::min((int)dimension, (int)delayValues.size()); ++i)
+    {
+        auto* lineEnd = delayMemory.data() + (i + 1) * lineStride;
+        std::fill(lineEnd - (size_t)delayValues[i] * laneStride, lineEnd, 0.f);
+    }
+}
+
+void BatchReverberator::Reset()
+{
+    if (maxBlockSize == 0)
+        return;
+    ClearReadRegions();
+    delayIdx = 0;
+    rotation.Reset();
+}
+
+void BatchReverberator::SetDimension(Reverberator::FdnDimension dim)
+{
+    dimension = dim;
+    rotation.SetDimension((int)dim);
+
+    auto N = (int)dimension;
+    auto matrix = Reverberator::CreateMixingMatrix(dimension);
+    mixingMatrix.resize(N * N);
+    for (auto i = 0; i < N; ++i)
+    {
+        auto row = matrix.GetRowSpan(i);
+        std::copy(row.begin(), row.end(), mixingMatrix.begin() + i * N);
+    }
+}
+
+void BatchReverberator::SetGain (float gain)
+{
+    this->gain = gain;
+    UpdateLineGains();
+}
+
+void BatchReverberator::SetDecayTime(float rt60Seconds, double sampleRate)
+{
+    decayTime = rt60Seconds;
+    decaySampleRate = sampleRate;
+    Reverberator::CalculateDecayGains(delayValues, decayTime, decaySampleRate, decayGains);
+    UpdateLineGains();
+}
+
+void BatchReverberator::UpdateLineGains()
+{
+    lineGains.resize(decayGains.size());
+    for (size_t i = 0; i < decayGains.size(); ++i)
+        lineGains[i] = gain * decayGains[i];
+}
+
+void BatchReverberator::SetModulation(float depthRadians, float rateHz, double sampleRate)
+{
+    rotation.SetModulation(depthRadians, rateHz, sampleRate);
+}
+
+int BatchReverberator::GetNumLanes() const
+{
+    return numLanes;
+}
+
+double BatchReverberator::GetTailSamples() const
+{
+    return CalculateTailSamples(delayValues, lineGains);
+}
+
+size_t BatchReverberator::GetMemoryBytes() const
+{
+    return delayMemory.capacity() * sizeof(float);
+}
+
+void BatchReverberator::Reverberate(const float* const* inputs, float* const* wetOutputs, unsigned blockLength)
+{
+    jassert((int)dimension == delayValues.size() && maxBlockSize > 0 && (int)blockLength <= maxBlockSize);
+
+    DspKernels::BatchState state;
+    state.dimension = (int)dimension;
+    state.numLanes = numLanes;
+    state.delayMemory = delayMemory.data();
+    state.mixingMatrix = mixingMatrix.data();
+    state.delayValues = delayValues.data();
+    state.delayIdx = delayIdx;
+    state.delayDepth = delayDepth;
+    state.lineGains = lineGains.data();
+    state.bValue = Reverberator::bValue;
+    state.cValue = Reverberator::cValue;
+    state.numRotationPairs = rotation.IsActive() ? rotation.GetNumPairs() : 0;
+    state.rotationCos = rotation.GetCosValues();
+    state.rotationSin = rotation.GetSinValues();
+
+    // laneStride is a power of two up to 8, the table is indexed by its log2
+    auto laneStrideIdx = (laneStride == 1) ? 0 : (laneStride == 2) ? 1 : (laneStride == 4) ? 2 : 3;
+    delayIdx = kernels.renderLanes[laneStrideIdx](state, inputs, wetOutputs, blockLength);
+
+    if (rotation.IsActive())
+        rotation.Advance(blockLength);
+}
@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    BatchReverberator.h
+    Created: 19 Oct 2026 10:12:05am
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "vector"
+
+#include "Reverberator.h"
+#include "ReverbEngine.h"
+#include "FeedbackRotation.h"
+#include "DspKernels.h"
+
+// K independent networks of the same dimension and delays processed together, one network per SIMD lane.
+// The delay memory is stored as [line][time][lane], so every tap read and every write-back is one
+// contiguous vector of lanes. This vectorises across the instances instead of across the lines,
+// so it works for the 2x2 and 4x4 networks as well as for the big ones.
+// The output of every lane is identical to the output of a Reverberator fed with the same input.
+// The render loop itself lives in BatchRenderKernel.h, built for several instruction sets (see DspKernels.h).
+// The default engine of the processor (see EngineRegistry).
+class BatchReverberator : public ReverbEngine
+{
+public:
+    static const int MaxLanes = 8; // one AVX register of floats
+
+    // firstPrime moves the delays to other prime numbers (see Reverberator::CalculateDelayValues())
+    BatchReverberator(Reverberator::FdnDimension dim, const std::vector<int>& powers, int numLanes, int firstPrime = 0);
+    ~BatchReverberator() {};
+
+    void Prepare(double sampleRate, int maxBlockSize) override;
+    // inputs and wetOutputs hold numLanes pointers each, the wet signal only is written
+    void Reverberate(const float* const* inputs, float* const* wetOutputs, unsigned blockLength) override;
+    void GenerateDelayValues(const std::vector<int>& powers) override;
+    void Reset() override;
+    void SetDimension(Reverberator::FdnDimension dim) override;
+    void SetGain (float gain) override;
+    void SetDecayTime(float rt60Seconds, double sampleRate) override; // see Reverberator::SetDecayTime()
+    void SetModulation(float depthRadians, float rateHz, double sampleRate) override; // see Reverberator::SetModulation()
+
+    int GetNumLanes() const override;
+    double GetTailSamples() const override;
+    size_t GetMemoryBytes() const override;
+
+private:
+    void UpdateDelayLines(int maxDelayLength);
+    void ClearReadRegions();
+    void UpdateLineGains();
+
+    Reverberator::FdnDimension dimension;
+    const int numLanes;
+    const int laneStride; // numLanes rounded up to a power of two, the unused lanes run on silence
+    const int firstPrime;
+    const DspKernels::KernelTable& kernels;
+
+    std::vector<float> delayMemory;
+    std::vector<float> mixingMatrix; // N x N, row after row
+    std::vector<int> delayValues;
+    float gain = 1.f;
+    float decayTime = 0.f;
+    double decaySampleRate = 44100.0;
+    std::vector<float> decayGains;
+    std::vector<float> lineGains; // gain times decayGains
+    FeedbackRotation rotation; // the same angles for all the lanes
+    int delayIdx = 0;
+    int delayDepth = 0;
+    int maxBlockSize = 0; // 0 until Prepare(), there is no delay memory before
+};
@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    CpuGovernor.cpp
+    Created: 21 Oct 2026 4:48:37pm
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#include "CpuGovernor.h"
+
+void CpuGovernor::prepare(double sampleRate, int numTiers)
+{
+    this->sampleRate = sampleRate;
+    this->numTiers = jmax(1, numTiers);
+    reset();
+}
+
+void CpuGovernor::reset()
+{
+    tier = 0;
+    load = 0.f;
+    overBudgetSeconds = 0.0;
+    underBudgetSeconds = 0.0;
+    holding = false;
+}
+
+void CpuGovernor::setBudget(float fractionOfDeadline)
+{
+    budget = jlimit(0.01f, 1.f, fractionOfDeadline);
+}
+
+void CpuGovernor::hold()
+{
+    holding = true;
+}
+
+int CpuGovernor::update(double elapsedSeconds, int numSamples)
+{
+    if (numSamples <= 0)
+        return tier;
+
+    auto blockSeconds = numSamples / sampleRate;
+    if (holding)
+    {
+        // both tiers run during a switch, the measurement would push the governor even further down
+        holding = false;
+        return tier;
+    }
+
+    load += LoadSmoothing * ((float)(elapsedSeconds / blockSeconds) - load);
+
+    overBudgetSeconds = (load > budget) ? overBudgetSeconds + blockSeconds : 0.0;
+    underBudgetSeconds = (load < budget * StepUpMargin) ? underBudgetSeconds + blockSeconds : 0.0;
+
+    if (overBudgetSeconds >= StepDownSeconds && tier < numTiers - 1)
+    {
+        ++tier;
+        load *= 0.5f; // the estimate for the smaller network, until it is measured
+        overBudgetSeconds = 0.0;
+    }
+    else if (underBudgetSeconds >= StepUpSeconds && tier > 0)
+    {
+        --tier;
+        load *= 2.f;
+        underBudgetSeconds = 0.0;
+    }
+    return tier;
+}
+
+int CpuGovernor::getTier() const
+{
+    return tier;
+}
+
+float CpuGovernor::getLoad() const
+{
+    return load;
+}
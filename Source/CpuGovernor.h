@@ -0,0 +1,47 @@
+/*
+  ==============================================================================
+
+    CpuGovernor.h
+    Created: 21 Oct 2026 4:48:37pm
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+// Watches how long processBlock takes against the block deadline (the duration of the block in real time)
+// and picks the quality tier to run: 0 is the full network, every next tier halves the lines.
+// The load is smoothed, a tier is dropped quickly when the budget is exceeded and regained slowly,
+// only when the load leaves room for a network twice as big. Everything here is audio thread only.
+class CpuGovernor
+{
+public:
+    void prepare(double sampleRate, int numTiers);
+    void reset(); // back to the full network
+    void setBudget(float fractionOfDeadline);
+
+    // returns the tier the next blocks should run with
+    int update(double elapsedSeconds, int numSamples);
+    void hold(); // the next measurement is not representative (a tier switch is in progress)
+
+    int getTier() const;
+    float getLoad() const;
+
+private:
+    double sampleRate = 44100.0;
+    int numTiers = 1;
+    int tier = 0;
+    float budget = 0.5f;
+    float load = 0.f; // smoothed elapsed time / deadline
+    double overBudgetSeconds = 0.0;
+    double underBudgetSeconds = 0.0;
+    bool holding = false;
+
+    const float LoadSmoothing = 0.1f;
+    const float StepUpMargin = 0.4f; // of the budget, a tier up costs about twice as much
+    const double StepDownSeconds = 0.05;
+    const double StepUpSeconds = 2.0;
+};
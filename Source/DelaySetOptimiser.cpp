@@ -0,0 +1,211 @@
+/*
+  ==============================================================================
+
+    DelaySetOptimiser.cpp
+    Created: 20 Oct 2026 3:17:44pm
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#include "DelaySetOptimiser.h"
+#include "atomic"
+#include "random"
+#include "thread"
+
+class DelaySetOptimiser::Worker
+{
+public:
+    Worker(const DelaySetOptimiser& owner, std::atomic<int64>& nextCandidate) :
+            owner(owner),
+            nextCandidate(nextCandidate),
+            reverberator(owner.settings.dimension, owner.getCandidate(0)),
+            ir((size_t)(owner.settings.irLengthSeconds * owner.settings.sampleRate), 0.f),
+            fft(findFftOrder((int)ir.size()))
+    {
+    }
+
+    void run()
+    {
+        auto numCandidates = owner.numCandidates;
+        for (;;)
+        {
+            auto first = nextCandidate.fetch_add(CandidatesPerFetch);
+            if (first >= numCandidates)
+                return;
+            for (auto idx = first; idx < std::min(first + CandidatesPerFetch, numCandidates); ++idx)
+                addResult(evaluate(owner.getCandidate(idx)));
+        }
+    }
+
+    std::vector<Result> results; // sorted, the best first
+
+private:
+    static int findFftOrder(int length)
+    {
+        auto order = 1;
+        while ((1 << order) < length)
+            ++order;
+        return order;
+    }
+
+    Result evaluate(const std::vector<int>& powers)
+    {
+        const auto& settings = owner.settings;
+
+        reverberator.GenerateDelayValues(powers);
+        std::fill(ir.begin(), ir.end(), 0.f);
+        ir[0] = 1.f;
+        reverberator.Reverberate(ir.data(), (unsigned)ir.size(), 1.f);
+
+        Result result;
+        result.powers = powers;
+        result.echoDensity = calculateEchoDensity(ir.data(), (int)ir.size(), (int)(IrAnalyser::EchoDensityWindowSeconds * settings.sampleRate));
+        result.flatness = calculateSpectralFlatness(ir.data(), (int)ir.size(), fft, fftBuffer);
+
+        float memory = 0.f;
+        for (auto &it : Reverberator::CalculateDelayValues(powers))
+            memory += (float)it;
+        result.memoryCost = memory / (float)(owner.N * Reverberator::MaxDelay);
+
+        result.score = settings.densityWeight * result.echoDensity
+                     + settings.flatnessWeight * result.flatness
+                     - settings.memoryWeight * result.memoryCost;
+        return result;
+    }
+
+    void addResult(Result&& result)
+    {
+        auto numResults = (size_t)owner.settings.numResults;
+        if (results.size() == numResults && result.score <= results.back().score)
+            return;
+        for (auto &it : results)
+            if (it.powers == result.powers)
+                return; // the sampling can pick the same candidate twice
+
+        auto position = std::upper_bound(results.begin(), results.end(), result,
+                                         [](const Result& a, const Result& b) { return a.score > b.score; });
+        results.insert(position, std::move(result));
+        if (results.size() > numResults)
+            results.pop_back();
+    }
+
+    const DelaySetOptimiser& owner;
+    std::atomic<int64>& nextCandidate;
+
+    Reverberator reverberator;
+    std::vector<float> ir;
+    dsp::FFT fft;
+    std::vector<float> fftBuffer;
+
+    static const int64 CandidatesPerFetch = 64;
+};
+
+DelaySetOptimiser::DelaySetOptimiser(const Settings& settings) :
+        settings(settings),
+        N((int)settings.dimension)
+{
+    auto searchSpaceSize = getSearchSpaceSize();
+    enumerate = searchSpaceSize <= settings.numCandidates;
+    numCandidates = enumerate ? searchSpaceSize : (int64)settings.numCandidates;
+}
+
+int64 DelaySetOptimiser::getNumCandidates() const
+{
+    return numCandidates;
+}
+
+int64 DelaySetOptimiser::getSearchSpaceSize() const
+{
+    int64 size = 1;
+    for (auto i = 0; i < N && size <= settings.numCandidates; ++i)
+        size *= Reverberator::GetMaxPower(i);
+    return size;
+}
+
+std::vector<int> DelaySetOptimiser::getCandidate(int64 candidateIdx) const
+{
+    // every candidate depends on its index only, so the results do not depend on the threads scheduling
+    std::vector<int> powers(N);
+    if (enumerate)
+    {
+        for (auto i = 0; i < N; ++i)
+        {
+            auto maxPower = Reverberator::GetMaxPower(i);
+            powers[i] = 1 + (int)(candidateIdx % maxPower);
+            candidateIdx /= maxPower;
+        }
+    }
+    else
+    {
+        std::mt19937 random(settings.seed + (uint32)candidateIdx * 2654435761u);
+        for (auto i = 0; i < N; ++i)
+            powers[i] = 1 + (int)(random() % (uint32)Reverberator::GetMaxPower(i));
+    }
+    return powers;
+}
+
+std::vector<DelaySetOptimiser::Result> DelaySetOptimiser::run()
+{
+    auto numThreads = (settings.numThreads > 0) ? settings.numThreads : jmax(1, (int)std::thread::hardware_concurrency());
+
+    std::atomic<int64> nextCandidate { 0 };
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (auto i = 0; i < numThreads; ++i)
+        workers.emplace_back(new Worker(*this, nextCandidate));
+
+    std::vector<std::thread> threads;
+    for (auto &it : workers)
+        threads.emplace_back([&it]() { it->run(); });
+    for (auto &it : threads)
+        it.join();
+
+    std::vector<Result> results;
+    for (auto &it : workers)
+        results.insert(results.end(), it->results.begin(), it->results.end());
+    std::sort(results.begin(), results.end(), [](const Result& a, const Result& b) { return a.score > b.score; });
+    results.erase(std::unique(results.begin(), results.end(), [](const Result& a, const Result& b) { return a.powers == b.powers; }), results.end());
+    if (results.size() > (size_t)settings.numResults)
+        results.resize(settings.numResults);
+    return results;
+}
+
+float DelaySetOptimiser::calculateEchoDensity(const float* ir, int length, int windowLength)
+{
+    // the mean over windows overlapping by half, the same windows as in the IR analysis
+    auto hop = jmax(1, windowLength / 2);
+    auto density = 0.f;
+    auto windows = 0;
+
+    for (auto start = 0; start + windowLength <= length; start += hop)
+    {
+        density += IrAnalyser::calculateEchoDensity(ir + start, windowLength);
+        ++windows;
+    }
+    return (windows > 0) ? density / (float)windows : 0.f;
+}
+
+float DelaySetOptimiser::calculateSpectralFlatness(const float* ir, int length, dsp::FFT& fft, std::vector<float>& fftBuffer)
+{
+    // the direct sound is skipped, a lone click would be perfectly flat
+    auto fftSize = fft.getSize();
+    fftBuffer.assign(2 * fftSize, 0.f);
+    if (length > 1)
+        std::copy(ir + 1, ir + jmin(length, fftSize), fftBuffer.begin());
+    fft.performFrequencyOnlyForwardTransform(fftBuffer.data());
+
+    // geometric mean over arithmetic mean of the power spectrum
+    const float Floor = 1e-12f;
+    auto logSum = 0.0;
+    auto sum = 0.0;
+    auto bins = fftSize / 2;
+    for (auto i = 1; i <= bins; ++i)
+    {
+        auto power = fftBuffer[i] * fftBuffer[i] + Floor;
+        logSum += std::log(power);
+        sum += power;
+    }
+    if (sum < bins * Floor * 2)
+        return 0.f; // no tail within the IR
+    return (float)(std::exp(logSum / bins) / (sum / bins));
+}
@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    DelaySetOptimiser.h
+    Created: 20 Oct 2026 3:17:44pm
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "vector"
+
+#include "Reverberator.h"
+#include "IrAnalyser.h"
+
+// Searches the delay powers of a network for the ones that sound best.
+// Every candidate gets a short impulse response rendered and scored for the echo density build-up,
+// the spectral flatness and the delay memory it needs. The candidates are split between all the cores,
+// each worker reuses its own Reverberator and buffers for all of its candidates.
+// The space is enumerated when it is not bigger than numCandidates, sampled otherwise.
+class DelaySetOptimiser
+{
+public:
+    struct Settings
+    {
+        Reverberator::FdnDimension dimension = Reverberator::FdnDimension::matrix8d;
+        int numCandidates = 20000;
+        int numResults = 10;
+        double sampleRate = 44100.0;
+        double irLengthSeconds = 0.2;
+        int numThreads = 0; // 0 uses all the cores
+        uint32 seed = 1;
+
+        float densityWeight = 1.f;
+        float flatnessWeight = 1.f;
+        float memoryWeight = 0.25f;
+    };
+
+    struct Result
+    {
+        std::vector<int> powers;
+        float score;
+        float echoDensity; // mean normalised echo density, about 1 for a fully diffuse tail
+        float flatness;    // spectral flatness of the IR, 0..1
+        float memoryCost;  // delay memory relative to the longest possible delays, 0..1
+    };
+
+    DelaySetOptimiser(const Settings& settings);
+
+    std::vector<Result> run(); // the best numResults candidates, the best one first
+    int64 getNumCandidates() const; // less than requested if the whole space is smaller
+
+    static float calculateEchoDensity(const float* ir, int length, int windowLength);
+    static float calculateSpectralFlatness(const float* ir, int length, dsp::FFT& fft, std::vector<float>& fftBuffer);
+
+private:
+    class Worker;
+
+    std::vector<int> getCandidate(int64 candidateIdx) const;
+    int64 getSearchSpaceSize() const;
+
+    const Settings settings;
+    const int N;
+    bool enumerate;
+    int64 numCandidates;
+};
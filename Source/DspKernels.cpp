@@ -0,0 +1,36 @@
+/*
+  ==============================================================================
+
+    DspKernels.cpp
+    Created: 23 Oct 2026 10:14:42am
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#include "DspKernels.h"
+
+namespace DspKernels
+{
+    namespace Generic
+    {
+        static const IsaLevel level = IsaLevel::generic;
+        #include "BatchRenderKernel.h"
+    }
+
+    const KernelTable& getGenericKernels()
+    {
+        return Generic::kernelTable;
+    }
+
+    const char* getIsaName(IsaLevel level)
+    {
+        switch (level)
+        {
+            case IsaLevel::sse42:  return "sse42";
+            case IsaLevel::avx2:   return "avx2";
+            case IsaLevel::avx512: return "avx512";
+            default:               return "generic";
+        }
+    }
+}
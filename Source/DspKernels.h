@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+    DspKernels.h
+    Created: 23 Oct 2026 10:14:42am
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "cstddef"
+
+// The hot loops of the networks, compiled once per instruction set level.
+// DspKernels.cpp holds the generic build, DspKernelsSse42/Avx2/Avx512.cpp the others; the Linux exporter passes
+// the matching -m flags (and -ffp-contract=off, so every level rounds the same) to these files only.
+// The Mac exporter passes none (arm64 and universal builds), the files compile to no table there.
+// Neither this header nor the kernel files include JUCE: an inline JUCE function compiled with -mavx2
+// could be the copy the linker keeps for the whole binary. The selection lives in DspKernelsDispatch.cpp.
+// The best level both compiled in and supported by the CPU is picked at the first use.
+// FDN_ISA_LEVEL=generic|sse42|avx2|avx512 in the environment forces a lower level for testing.
+namespace DspKernels
+{
+    enum class IsaLevel { generic, sse42, avx2, avx512 };
+
+    static const int MaxDimension = 16;
+
+    // everything a block of BatchReverberator needs, the delay memory is [line][time][lane]
+    struct BatchState
+    {
+        int dimension;
+        int numLanes;
+        float* delayMemory;
+        const float* mixingMatrix; // N x N, row after row
+        const int* delayValues;
+        int delayIdx;
+        int delayDepth;
+        const float* lineGains; // per line, the decay gain and the RT60 attenuation together
+        float bValue;
+        float cValue;
+        int numRotationPairs; // 0 if the feedback rotation is off
+        const float* rotationCos;
+        const float* rotationSin;
+    };
+
+    // returns the delay index after the block
+    using RenderLanesFunction = int (*)(const BatchState& state, const float* const* inputs, float* const* wetOutputs, unsigned blockLength);
+
+    struct KernelTable
+    {
+        IsaLevel level;
+        RenderLanesFunction renderLanes[4]; // lane strides 1, 2, 4 and 8
+    };
+
+    const KernelTable& getKernels();
+    IsaLevel getSelectedLevel(); // the level getKernels() runs with, after the CPU check and FDN_ISA_LEVEL
+    const char* getIsaName(IsaLevel level);
+
+    // the tables of the translation units, nullptr if the file was built without the flags of its level
+    const KernelTable& getGenericKernels();
+    const KernelTable* getSse42Kernels();
+    const KernelTable* getAvx2Kernels();
+    const KernelTable* getAvx512Kernels();
+}
@@ -0,0 +1,32 @@
+/*
+  ==============================================================================
+
+    DspKernelsAvx2.cpp
+    Created: 23 Oct 2026 10:14:42am
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#include "DspKernels.h"
+
+namespace DspKernels
+{
+#if defined (__AVX2__)
+    namespace Avx2
+    {
+        static const IsaLevel level = IsaLevel::avx2;
+        #include "BatchRenderKernel.h"
+    }
+
+    const KernelTable* getAvx2Kernels()
+    {
+        return &Avx2::kernelTable;
+    }
+#else
+    const KernelTable* getAvx2Kernels()
+    {
+        return nullptr; // built without -mavx2 (see DspKernels.h)
+    }
+#endif
+}
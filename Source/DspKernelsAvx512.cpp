@@ -0,0 +1,32 @@
+/*
+  ==============================================================================
+
+    DspKernelsAvx512.cpp
+    Created: 23 Oct 2026 10:14:42am
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#include "DspKernels.h"
+
+namespace DspKernels
+{
+#if defined (__AVX512F__) && defined (__AVX512VL__)
+    namespace Avx512
+    {
+        static const IsaLevel level = IsaLevel::avx512;
+        #include "BatchRenderKernel.h"
+    }
+
+    const KernelTable* getAvx512Kernels()
+    {
+        return &Avx512::kernelTable;
+    }
+#else
+    const KernelTable* getAvx512Kernels()
+    {
+        return nullptr; // built without -mavx512f -mavx512vl (see DspKernels.h)
+    }
+#endif
+}
@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    DspKernelsDispatch.cpp
+    Created: 29 Oct 2026 9:41:18am
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "DspKernels.h"
+
+// built with the flags of the project, this is the only kernel file that may use JUCE
+namespace DspKernels
+{
+    static bool isSupported(IsaLevel level)
+    {
+        switch (level)
+        {
+            case IsaLevel::sse42:  return SystemStats::hasSSE42();
+            case IsaLevel::avx2:   return SystemStats::hasAVX2();
+            case IsaLevel::avx512: return SystemStats::hasAVX512F() && SystemStats::hasAVX512VL();
+            default:               return true;
+        }
+    }
+
+    static IsaLevel getMaxAllowedLevel()
+    {
+        auto forced = SystemStats::getEnvironmentVariable("FDN_ISA_LEVEL", {}).trim().toLowerCase();
+        for (auto level : {IsaLevel::generic, IsaLevel::sse42, IsaLevel::avx2, IsaLevel::avx512})
+            if (forced == getIsaName(level))
+                return level;
+        return IsaLevel::avx512;
+    }
+
+    static const KernelTable& selectKernels()
+    {
+        const KernelTable* candidates[] = { getAvx512Kernels(), getAvx2Kernels(), getSse42Kernels() };
+        auto maxLevel = getMaxAllowedLevel();
+        for (auto* table : candidates)
+        {
+            if (table != nullptr && table->level <= maxLevel && isSupported(table->level))
+                return *table;
+        }
+        return getGenericKernels();
+    }
+
+    const KernelTable& getKernels()
+    {
+        static const KernelTable& kernels = selectKernels(); // the detection runs once, thread-safe
+        return kernels;
+    }
+
+    IsaLevel getSelectedLevel()
+    {
+        return getKernels().level;
+    }
+}
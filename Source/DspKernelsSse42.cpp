@@ -0,0 +1,32 @@
+/*
+  ==============================================================================
+
+    DspKernelsSse42.cpp
+    Created: 23 Oct 2026 10:14:42am
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#include "DspKernels.h"
+
+namespace DspKernels
+{
+#if defined (__SSE4_2__)
+    namespace Sse42
+    {
+        static const IsaLevel level = IsaLevel::sse42;
+        #include "BatchRenderKernel.h"
+    }
+
+    const KernelTable* getSse42Kernels()
+    {
+        return &Sse42::kernelTable;
+    }
+#else
+    const KernelTable* getSse42Kernels()
+    {
+        return nullptr; // built without -msse4.2 (see DspKernels.h)
+    }
+#endif
+}
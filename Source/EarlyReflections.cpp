@@ -0,0 +1,154 @@
+/*
+  ==============================================================================
+
+    EarlyReflections.cpp
+    Created: 24 Oct 2026 11:40:26am
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#include "EarlyReflections.h"
+
+void EarlyReflections::Prepare(double sampleRate, int maxBlockLength, int numLanes)
+{
+    jassert(numLanes > 0 && numLanes <= MaxLanes);
+    this->sampleRate = sampleRate;
+    this->numLanes = numLanes;
+    laneStride = nextPowerOfTwo(numLanes);
+
+    // the history holds the whole block being processed plus the latest reflection
+    auto historyLength = nextPowerOfTwo((int)(MaxReflectionSeconds * sampleRate) + maxBlockLength);
+    historyMask = historyLength - 1;
+    history.assign((size_t)historyLength * laneStride, 0.f);
+    accumulator.assign((size_t)maxBlockLength * laneStride, 0.f);
+    writePosition = 0;
+    level.reset(sampleRate, LevelSmoothingSeconds);
+    level.setCurrentAndTargetValue(0.f);
+    numTaps = 0;
+}
+
+void EarlyReflections::SetRoom(float roomSizeMetres)
+{
+    // the taps are sorted by delay, the ones beyond the history are cut off the end
+    numTaps = CalculateRoomTaps(roomSizeMetres, sampleRate, taps.data());
+    auto maxDelay = historyMask + 1 - (int)(accumulator.size() / laneStride);
+    while (numTaps > 0 && taps[(size_t)numTaps - 1].delay > maxDelay)
+        --numTaps;
+}
+
+void EarlyReflections::SetLevel(float newLevel)
+{
+    if (! IsActive() && newLevel > 0.f)
+    {
+        Reset(); // the history is not updated while the stage is off
+        level.setCurrentAndTargetValue(0.f);
+    }
+    level.setTargetValue(newLevel);
+}
+
+void EarlyReflections::Reset()
+{
+    std::fill(history.begin(), history.end(), 0.f);
+    writePosition = 0;
+}
+
+void EarlyReflections::Release()
+{
+    // the taps were fitted into the history, SetRoom() has to follow the next Prepare()
+    numTaps = 0;
+    std::vector<float>().swap(history);
+    std::vector<float>().swap(accumulator);
+    historyMask = 0;
+    writePosition = 0;
+}
+
+bool EarlyReflections::IsActive() const
+{
+    return (level.getTargetValue() > 0.f || level.isSmoothing()) && numTaps > 0;
+}
+
+int EarlyReflections::CalculateRoomTaps(float roomSizeMetres, double sampleRate, Tap* taps)
+{
+    // a shoebox of size x 0.8 size x 0.35 size, the source and the listener at fixed relative positions,
+    // every image source up to the second order becomes a tap
+    const float SpeedOfSound = 343.f;
+    const float WallReflection = 0.8f;
+    const float room[3] = { roomSizeMetres, 0.8f * roomSizeMetres, 0.35f * roomSizeMetres };
+    const float source[3] = { 0.3f * room[0], 0.4f * room[1], 0.5f * room[2] };
+    const float listener[3] = { 0.7f * room[0], 0.6f * room[1], 0.4f * room[2] };
+
+    auto getDistance = [&](const int order[3])
+    {
+        auto sum = 0.f;
+        for (auto axis = 0; axis < 3; ++axis)
+        {
+            // the image of the source behind order[axis] walls along the axis
+            auto m = order[axis];
+            auto image = 2.f * std::ceil(m / 2.f) * room[axis] + ((m % 2 == 0) ? source[axis] : -source[axis]);
+            sum += (image - listener[axis]) * (image - listener[axis]);
+        }
+        return std::sqrt(sum);
+    };
+
+    const int direct[3] = { 0, 0, 0 };
+    auto directDistance = getDistance(direct);
+
+    auto numTaps = 0;
+    for (auto x = -2; x <= 2; ++x)
+    {
+        for (auto y = -2; y <= 2; ++y)
+        {
+            for (auto z = -2; z <= 2; ++z)
+            {
+                auto reflections = std::abs(x) + std::abs(y) + std::abs(z);
+                if (reflections == 0 || reflections > 2)
+                    continue;
+                const int order[3] = { x, y, z };
+                auto distance = getDistance(order);
+                auto delay = (int)((distance - directDistance) / SpeedOfSound * sampleRate);
+                auto gain = directDistance / distance * std::pow(WallReflection, (float)reflections);
+                jassert(numTaps < MaxTaps);
+                taps[numTaps++] = { jmax(1, delay), gain };
+            }
+        }
+    }
+    std::sort(taps, taps + numTaps, [](const Tap& a, const Tap& b) { return a.delay < b.delay; });
+    return numTaps;
+}
+
+void EarlyReflections::Process(const float* const* inputs, float* const* outputs, unsigned blockLength)
+{
+    jassert(blockLength * laneStride <= accumulator.size());
+    const int historyLength = historyMask + 1;
+
+    // the block is written first, so the taps shorter than the block read from it as well
+    for (auto n = 0; n < (int)blockLength; ++n)
+    {
+        float* frame = &history[(size_t)((writePosition + n) & historyMask) * laneStride];
+        for (auto k = 0; k < numLanes; ++k)
+            frame[k] = inputs[k][n];
+    }
+
+    auto* acc = accumulator.data();
+    FloatVectorOperations::clear(acc, (int)blockLength * laneStride);
+    for (auto i = 0; i < numTaps; ++i)
+    {
+        const auto& tap = taps[(size_t)i];
+        // one tap is at most two contiguous runs of the history (before and after its wrap)
+        auto readPosition = (writePosition - tap.delay) & historyMask;
+        auto firstRun = jmin((int)blockLength, historyLength - readPosition);
+        FloatVectorOperations::addWithMultiply(acc, &history[(size_t)readPosition * laneStride], tap.gain, firstRun * laneStride);
+        if (firstRun < (int)blockLength)
+            FloatVectorOperations::addWithMultiply(acc + firstRun * laneStride, history.data(), tap.gain, ((int)blockLength - firstRun) * laneStride);
+    }
+
+    for (auto n = 0; n < (int)blockLength; ++n)
+    {
+        auto gain = level.getNextValue();
+        for (auto k = 0; k < numLanes; ++k)
+            outputs[k][n] = gain * acc[n * laneStride + k];
+    }
+
+    writePosition = (writePosition + (int)blockLength) & historyMask;
+}
@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+    EarlyReflections.h
+    Created: 24 Oct 2026 11:40:26am
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "vector"
+#include "array"
+
+// Distinct early reflections from a sparse set of taps on one shared input history.
+// The taps come from the first and second order image sources of a shoebox room (see CalculateRoomTaps()),
+// they are recalculated only when the room changes. The level is a smoothed gain on the output.
+// The history is [time][lane], so a tap over a whole block is one or two contiguous multiply-adds
+// of blockLength * lanes floats: the cost depends on the number of taps, not on how late they are.
+class EarlyReflections
+{
+public:
+    struct Tap
+    {
+        int delay; // samples after the direct sound
+        float gain;
+    };
+
+    static const int MaxLanes = 8;
+    static const int MaxTaps = 24; // the image sources of the first and the second order
+
+    void Prepare(double sampleRate, int maxBlockLength, int numLanes);
+    void SetRoom(float roomSizeMetres); // does not allocate
+    void SetLevel(float level); // level 0 turns the stage off once the level has faded out
+    void Reset();
+    void Release(); // frees the memory until the next Prepare()
+    bool IsActive() const;
+
+    // inputs and outputs hold numLanes pointers each, outputs get the reflections only
+    void Process(const float* const* inputs, float* const* outputs, unsigned blockLength);
+
+    // fills taps sorted by delay, returns their number (at most MaxTaps)
+    static int CalculateRoomTaps(float roomSizeMetres, double sampleRate, Tap* taps);
+
+private:
+    double sampleRate = 44100.0;
+    int numLanes = 1;
+    int laneStride = 1; // numLanes rounded up to a power of two
+    std::array<Tap, MaxTaps> taps;
+    int numTaps = 0;
+    std::vector<float> history; // a power of two frames long
+    std::vector<float> accumulator; // [time][lane], one block
+    int historyMask = 0;
+    int writePosition = 0;
+    LinearSmoothedValue<float> level;
+
+    const double MaxReflectionSeconds = 0.3;
+    const double LevelSmoothingSeconds = 0.05;
+};
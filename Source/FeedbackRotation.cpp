@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+
+    FeedbackRotation.cpp
+    Created: 22 Oct 2026 11:02:19am
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#include "FeedbackRotation.h"
+
+void FeedbackRotation::SetDimension(int N)
+{
+    auto numPairs = (size_t)N / 2;
+    phases.resize(numPairs);
+    phaseIncrements.resize(numPairs);
+    cosValues.resize(numPairs);
+    sinValues.resize(numPairs);
+    SetModulation(depth, rate, sampleRate);
+    Reset();
+}
+
+void FeedbackRotation::SetModulation(float depthRadians, float rateHz, double sampleRate)
+{
+    depth = depthRadians;
+    rate = rateHz;
+    this->sampleRate = sampleRate;
+    
+    // the rates are spread over rateHz .. 1.5 * rateHz, so the pairs drift against each other
+    auto numPairs = phaseIncrements.size();
+    for (size_t pair = 0; pair < numPairs; ++pair)
+    {
+        auto pairRate = rateHz * (1.0 + 0.5 * (double)pair / (double)jmax((size_t)1, numPairs));
+        phaseIncrements[pair] = 2.0 * MathConstants<double>::pi * pairRate / sampleRate;
+    }
+    UpdateAngles();
+}
+
+void FeedbackRotation::Reset()
+{
+    auto numPairs = phases.size();
+    for (size_t pair = 0; pair < numPairs; ++pair)
+        phases[pair] = 2.0 * MathConstants<double>::pi * (double)pair / (double)numPairs;
+    UpdateAngles();
+}
+
+void FeedbackRotation::Advance(unsigned numSamples)
+{
+    for (size_t pair = 0; pair < phases.size(); ++pair)
+        phases[pair] = std::fmod(phases[pair] + phaseIncrements[pair] * numSamples, 2.0 * MathConstants<double>::pi);
+    UpdateAngles();
+}
+
+void FeedbackRotation::UpdateAngles()
+{
+    for (size_t pair = 0; pair < phases.size(); ++pair)
+    {
+        auto angle = depth * (float)std::sin(phases[pair]);
+        cosValues[pair] = std::cos(angle);
+        sinValues[pair] = std::sin(angle);
+    }
+}
+
+bool FeedbackRotation::IsActive() const
+{
+    return depth > 0.f;
+}
+
+int FeedbackRotation::GetNumPairs() const
+{
+    return (int)cosValues.size();
+}
+
+const float* FeedbackRotation::GetCosValues() const
+{
+    return cosValues.data();
+}
+
+const float* FeedbackRotation::GetSinValues() const
+{
+    return sinValues.data();
+}
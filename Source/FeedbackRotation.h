@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    FeedbackRotation.h
+    Created: 22 Oct 2026 11:02:19am
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "vector"
+
+// Slowly modulated Givens rotations applied to the delay lines outputs before the Hadamard matrix,
+// so the feedback matrix becomes H * R(t). Every rotation mixes one pair of lines and is orthogonal,
+// the product stays lossless, and it costs 4 multiplications per pair instead of N^2 for a new matrix.
+// The angles are updated once per block (see Advance()), each pair has its own rate and phase
+// so the modal patterns do not move in lockstep.
+class FeedbackRotation
+{
+public:
+    void SetDimension(int N);
+    void SetModulation(float depthRadians, float rateHz, double sampleRate); // depth 0 turns the stage off
+    void Reset(); // back to the starting phases, so a render is reproducible
+    void Advance(unsigned numSamples);
+    
+    bool IsActive() const;
+    int GetNumPairs() const;
+    const float* GetCosValues() const;
+    const float* GetSinValues() const;
+    
+    // vector is [line][lane], lanes floats per line
+    template <int lanes> void Apply(float* vector) const
+    {
+        for (size_t pair = 0; pair < cosValues.size(); ++pair)
+        {
+            auto c = cosValues[pair];
+            auto s = sinValues[pair];
+            float* a = vector + 2 * pair * lanes;
+            float* b = a + lanes;
+            for (auto k = 0; k < lanes; ++k)
+            {
+                auto rotatedA = c * a[k] - s * b[k];
+                b[k] = s * a[k] + c * b[k];
+                a[k] = rotatedA;
+            }
+        }
+    }
+    
+private:
+    void UpdateAngles();
+    
+    float depth = 0.f;
+    std::vector<double> phases;
+    std::vector<double> phaseIncrements; // per sample
+    std::vector<float> cosValues;
+    std::vector<float> sinValues;
+    float rate = 0.f;
+    double sampleRate = 44100.0;
+};
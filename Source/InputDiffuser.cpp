@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+
+    InputDiffuser.cpp
+    Created: 22 Oct 2026 3:36:50pm
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#include "InputDiffuser.h"
+
+void InputDiffuser::Prepare(double sampleRate, int numLanes)
+{
+    jassert(numLanes > 0 && numLanes <= MaxLanes);
+    this->numLanes = numLanes;
+    laneStride = nextPowerOfTwo(numLanes);
+
+    // mutually prime delays of 5..13 ms at 44.1 kHz (the Freeverb allpass tunings), shortest first
+    const int Delays44k[NumStages] = {225, 341, 441, 556};
+    auto size = 0;
+    for (auto stage = 0; stage < NumStages; ++stage)
+    {
+        delays[stage] = jmax(1, (int)(Delays44k[stage] * sampleRate / 44100.0));
+        offsets[stage] = size;
+        size += delays[stage] * laneStride;
+    }
+    memory.assign((size_t)size, 0.f);
+    positions.fill(0);
+}
+
+void InputDiffuser::SetAmount(float amount)
+{
+    auto newGain = MaxAllpassGain * jlimit(0.f, 1.f, amount);
+    if (allpassGain == 0.f && newGain > 0.f)
+        Reset(); // the memory is not updated while bypassed
+    allpassGain = newGain;
+}
+
+void InputDiffuser::Reset()
+{
+    std::fill(memory.begin(), memory.end(), 0.f);
+    positions.fill(0);
+}
+
+void InputDiffuser::Release()
+{
+    std::vector<float>().swap(memory);
+    positions.fill(0);
+}
+
+bool InputDiffuser::IsActive() const
+{
+    return allpassGain > 0.f;
+}
+
+void InputDiffuser::Process(const float* const* inputs, float* const* outputs, unsigned blockLength)
+{
+    switch (laneStride)
+    {
+        case 1:  ProcessLanes<1>(inputs, outputs, blockLength); break;
+        case 2:  ProcessLanes<2>(inputs, outputs, blockLength); break;
+        case 4:  ProcessLanes<4>(inputs, outputs, blockLength); break;
+        default: ProcessLanes<8>(inputs, outputs, blockLength); break;
+    }
+}
+
+template <int lanes>
+void InputDiffuser::ProcessLanes(const float* const* inputs, float* const* outputs, unsigned blockLength)
+{
+    const auto g = allpassGain;
+    float x[lanes] = {};
+
+    for (auto n = 0; n < blockLength; ++n)
+    {
+        for (auto k = 0; k < numLanes; ++k)
+            x[k] = inputs[k][n];
+
+        for (auto stage = 0; stage < NumStages; ++stage)
+        {
+            // w[n] = x[n] + g * w[n - D], y[n] = w[n - D] - g * w[n]
+            float* w = &memory[offsets[stage] + positions[stage] * lanes];
+            for (auto k = 0; k < lanes; ++k)
+            {
+                auto delayed = w[k];
+                auto v = x[k] + g * delayed;
+                w[k] = v;
+                x[k] = delayed - g * v;
+            }
+            if (++positions[stage] == delays[stage])
+                positions[stage] = 0;
+        }
+
+        for (auto k = 0; k < numLanes; ++k)
+            outputs[k][n] = x[k];
+    }
+}
@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    InputDiffuser.h
+    Created: 22 Oct 2026 3:36:50pm
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "array"
+#include "vector"
+
+// A cascade of Schroeder allpasses in front of the network, so a transient enters the lines already smeared
+// into a dense burst instead of a single click. The channels run side by side like the lanes of a
+// BatchReverberator: the memory of every stage is [time][lane], each stage costs two multiplications
+// per sample and lane, the whole cascade is cheaper than one extra line of an 8x8 network.
+class InputDiffuser
+{
+public:
+    static const int NumStages = 4;
+    static const int MaxLanes = 8;
+
+    void Prepare(double sampleRate, int numLanes);
+    void SetAmount(float amount); // 0..1, 0 bypasses the stage
+    void Reset();
+    void Release(); // frees the memory until the next Prepare()
+    bool IsActive() const;
+
+    // inputs and outputs hold numLanes pointers each, they may point to the same memory
+    void Process(const float* const* inputs, float* const* outputs, unsigned blockLength);
+
+private:
+    template <int lanes> void ProcessLanes(const float* const* inputs, float* const* outputs, unsigned blockLength);
+
+    int numLanes = 1;
+    int laneStride = 1; // numLanes rounded up to a power of two
+    float allpassGain = 0.f;
+
+    std::vector<float> memory; // all the stages one after another
+    std::array<int, NumStages> delays {};
+    std::array<int, NumStages> offsets {};
+    std::array<int, NumStages> positions {};
+
+    const float MaxAllpassGain = 0.7f;
+};
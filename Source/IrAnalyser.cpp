@@ -0,0 +1,158 @@
+/*
+  ==============================================================================
+
+    IrAnalyser.cpp
+    Created: 21 Oct 2026 10:26:03am
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#include "IrAnalyser.h"
+
+IrAnalyser::IrAnalyser(double sampleRate, int expectedLength) :
+        sampleRate(sampleRate),
+        echoWindowLength(jmax(2, (int)(EchoDensityWindowSeconds * sampleRate)))
+{
+    // octave band-passes, Q = sqrt(2) gives one octave of bandwidth
+    const double Q = std::sqrt(2.0);
+    for (auto band = 0; band < NumBands; ++band)
+    {
+        auto frequency = jmin((double)getBandCentreFrequency(band), 0.45 * sampleRate);
+        auto w0 = 2.0 * MathConstants<double>::pi * frequency / sampleRate;
+        auto alpha = std::sin(w0) / (2.0 * Q);
+        auto a0 = 1.0 + alpha;
+        b0[band] = (float)(alpha / a0);
+        b2[band] = (float)(-alpha / a0);
+        a1[band] = (float)(-2.0 * std::cos(w0) / a0);
+        a2[band] = (float)((1.0 - alpha) / a0);
+    }
+
+    auto expectedBins = (size_t)(expectedLength / BinLength + 1);
+    for (auto &it : bandEnergySums)
+        it.reserve(expectedBins);
+    broadbandEnergySums.reserve(expectedBins);
+    echoWindow.assign(echoWindowLength, 0.f);
+}
+
+float IrAnalyser::getBandCentreFrequency(int band)
+{
+    return 62.5f * (float)(1 << band); // 62.5 Hz .. 8 kHz
+}
+
+void IrAnalyser::addBlock(const float* samples, int numSamples)
+{
+    for (auto n = 0; n < numSamples; ++n)
+    {
+        auto x = samples[n];
+
+        for (auto band = 0; band < NumBands; ++band)
+        {
+            auto y = b0[band] * x + z1[band];
+            z1[band] = -a1[band] * y + z2[band];
+            z2[band] = b2[band] * x - a2[band] * y;
+            currentBinEnergies[band] += y * y;
+        }
+        currentBroadbandEnergy += x * x;
+
+        if (++currentBinLength == BinLength)
+        {
+            for (auto band = 0; band < NumBands; ++band)
+                bandEnergySums[band].push_back((bandEnergySums[band].empty() ? 0.0 : bandEnergySums[band].back()) + currentBinEnergies[band]);
+            broadbandEnergySums.push_back((broadbandEnergySums.empty() ? 0.0 : broadbandEnergySums.back()) + currentBroadbandEnergy);
+            currentBinEnergies.fill(0.f);
+            currentBroadbandEnergy = 0.f;
+            currentBinLength = 0;
+        }
+
+        echoWindow[echoWindowIdx] = x;
+        if (++echoWindowIdx == echoWindowLength)
+            echoWindowIdx = 0;
+        ++samplesAnalysed;
+
+        // the windows overlap by half, the first one is taken as soon as it is full
+        if (++samplesSinceLastWindow >= echoWindowLength / 2 && samplesAnalysed >= echoWindowLength)
+        {
+            addEchoDensityWindow();
+            samplesSinceLastWindow = 0;
+        }
+    }
+}
+
+float IrAnalyser::calculateEchoDensity(const float* window, int windowLength)
+{
+    // normalised echo density (Abel & Huang): the share of the samples outside of one standard deviation
+    // of the window, divided by the share expected for gaussian noise
+    const float GaussianShare = 0.3173f; // erfc(1 / sqrt(2))
+
+    auto energy = 0.f;
+    for (auto n = 0; n < windowLength; ++n)
+        energy += window[n] * window[n];
+    auto deviation = std::sqrt(energy / (float)windowLength);
+
+    auto outliers = 0;
+    for (auto n = 0; n < windowLength; ++n)
+        outliers += (std::abs(window[n]) > deviation) ? 1 : 0;
+
+    return (float)outliers / (float)windowLength / GaussianShare;
+}
+
+void IrAnalyser::addEchoDensityWindow()
+{
+    // the order of the samples does not matter for the density, the circular window is taken as it is
+    echoDensity.push_back(calculateEchoDensity(echoWindow.data(), echoWindowLength));
+    if (echoDensityBuildUpWindow < 0 && echoDensity.back() >= 1.f)
+        echoDensityBuildUpWindow = (int)echoDensity.size() - 1;
+}
+
+int IrAnalyser::findEdcBin(const std::vector<double>& energySums, double levelDb)
+{
+    // EDC(bin) = total - the sum before bin is at or below the level once that sum reaches the threshold,
+    // the sums never decrease, so it is a binary search; -1 if the EDC has not decayed that far yet
+    auto threshold = energySums.back() * (1.0 - std::pow(10.0, levelDb / 10.0));
+    auto found = std::lower_bound(energySums.begin(), energySums.end() - 1, threshold);
+    return (found == energySums.end() - 1) ? -1 : (int)(found - energySums.begin()) + 1;
+}
+
+float IrAnalyser::calculateRt60(const std::vector<double>& energySums) const
+{
+    // T20: the time the EDC takes from -5 dB to -25 dB, times 3
+    if (energySums.empty() || energySums.back() <= 0.0)
+        return 0.f;
+
+    auto start = findEdcBin(energySums, -5.0);
+    auto end = findEdcBin(energySums, -25.0);
+    if (start < 0 || end < 0)
+        return 0.f;
+    return (float)(3.0 * (end - start) * BinLength / sampleRate);
+}
+
+std::vector<float> IrAnalyser::getEdcDb() const
+{
+    std::vector<float> edcDb (broadbandEnergySums.size());
+    if (edcDb.empty())
+        return edcDb;
+
+    // a difference of the running sums, so the curve bottoms out around -150 dB (the resolution of a double)
+    auto total = (broadbandEnergySums.back() > 0.0) ? broadbandEnergySums.back() : 1.0;
+    for (auto bin = 0; bin < (int)edcDb.size(); ++bin)
+    {
+        auto remaining = broadbandEnergySums.back() - ((bin > 0) ? broadbandEnergySums[bin - 1] : 0.0);
+        edcDb[bin] = (float)(10.0 * std::log10(jmax(remaining / total, 1e-30)));
+    }
+    return edcDb;
+}
+
+IrAnalyser::Results IrAnalyser::getResults() const
+{
+    Results results;
+    results.samplesAnalysed = samplesAnalysed;
+
+    results.broadbandRt60 = calculateRt60(broadbandEnergySums);
+    for (auto band = 0; band < NumBands; ++band)
+        results.rt60[band] = calculateRt60(bandEnergySums[band]);
+
+    if (echoDensityBuildUpWindow >= 0)
+        results.echoDensityBuildUpSeconds = (float)(echoDensityBuildUpWindow * (echoWindowLength / 2) / sampleRate);
+    return results;
+}
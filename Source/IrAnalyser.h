@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    IrAnalyser.h
+    Created: 21 Oct 2026 10:26:03am
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "array"
+#include "vector"
+
+// Energy decay curve, RT60 per octave band and echo density profile of an impulse response.
+// The IR is fed block by block while it is being rendered, every addBlock() is O(block length),
+// getResults() can be called at any moment, it is O(log n) and describes the part of the IR received so far.
+// The octave filters of all the bands run side by side (one band per SIMD lane),
+// the energies are kept as running sums over bins of BinLength samples, the EDC of a bin is the total minus the sum before it.
+class IrAnalyser
+{
+public:
+    static const int NumBands = 8;
+    static const int BinLength = 64;
+
+    static constexpr double EchoDensityWindowSeconds = 0.02;
+
+    struct Results
+    {
+        std::array<float, NumBands> rt60;       // seconds, 0 if the EDC has not decayed enough yet
+        float broadbandRt60 = 0.f;
+        float echoDensityBuildUpSeconds = 0.f;  // when the density reaches 1 for the first time, 0 if never
+        int samplesAnalysed = 0;
+    };
+
+    IrAnalyser(double sampleRate, int expectedLength = 0);
+
+    void addBlock(const float* samples, int numSamples);
+    Results getResults() const;
+
+    // the whole curves, O(n) each: meant for the complete IR, not for every update
+    std::vector<float> getEdcDb() const; // broadband EDC per bin, 0 dB at the start
+    const std::vector<float>& getEchoDensity() const { return echoDensity; } // normalised echo density per window
+
+    static float getBandCentreFrequency(int band);
+    static float calculateEchoDensity(const float* window, int windowLength); // normalised echo density of one window
+
+private:
+    void addEchoDensityWindow();
+    float calculateRt60(const std::vector<double>& energySums) const;
+    static int findEdcBin(const std::vector<double>& energySums, double levelDb);
+
+    const double sampleRate;
+
+    // band-pass biquads, transposed direct form II, [band] arrays so the loop over the bands vectorises
+    alignas(32) std::array<float, NumBands> b0, b2, a1, a2; // b1 of a band-pass is 0
+    alignas(32) std::array<float, NumBands> z1 {}, z2 {};
+    alignas(32) std::array<float, NumBands> currentBinEnergies {};
+
+    // [bin] is the energy of the bins up to and including bin, in double: the sums grow over the whole IR
+    std::array<std::vector<double>, NumBands> bandEnergySums;
+    std::vector<double> broadbandEnergySums;
+    float currentBroadbandEnergy = 0.f;
+    int currentBinLength = 0;
+
+    std::vector<float> echoWindow; // the last window of samples, circular
+    int echoWindowIdx = 0;
+    int samplesSinceLastWindow = 0;
+    std::vector<float> echoDensity;
+    int echoDensityBuildUpWindow = -1;
+    const int echoWindowLength;
+
+    int samplesAnalysed = 0;
+};
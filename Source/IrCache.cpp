@@ -0,0 +1,236 @@
+/*
+  ==============================================================================
+
+    IrCache.cpp
+    Created: 20 Oct 2026 11:02:37am
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#include "IrCache.h"
+
+bool IrCache::Key::operator< (const Key& other) const
+{
+    return std::tie(dimension, powers, matrixType, decaySamples, gain, length)
+         < std::tie(other.dimension, other.powers, other.matrixType, other.decaySamples, other.gain, other.length);
+}
+
+bool IrCache::Key::operator== (const Key& other) const
+{
+    return ! (*this < other) && ! (other < *this);
+}
+
+uint64 IrCache::Key::getHash() const
+{
+    // FNV-1a over all the fields, it names the files of the persistent cache
+    uint64 hash = 14695981039346656037ull;
+    auto addValue = [&hash](int64 value)
+    {
+        for (auto i = 0; i < 8; ++i)
+        {
+            hash ^= (uint64)((value >> (8 * i)) & 0xff);
+            hash *= 1099511628211ull;
+        }
+    };
+
+    addValue((int64)dimension);
+    for (auto &it : powers)
+        addValue(it);
+    addValue((int64)matrixType);
+    addValue(decaySamples);
+    uint32 gainBits;
+    std::memcpy(&gainBits, &gain, sizeof(gainBits));
+    addValue(gainBits);
+    addValue(length);
+    return hash;
+}
+
+IrCache::IrCache(size_t maxBytes) : maxBytes(maxBytes)
+{
+}
+
+IrCache::ImpulseResponse IrCache::getImpulseResponse(const Key& key)
+{
+    {
+        const ScopedLock sl (lock);
+        auto found = index.find(key);
+        if (found != index.end())
+        {
+            entries.splice(entries.begin(), entries, found->second);
+            return found->second->second;
+        }
+    }
+
+    // rendering is done without the lock, the other callers can use the cache meanwhile
+    auto impulseResponse = load(key);
+    if (impulseResponse == nullptr)
+    {
+        impulseResponse = render(key);
+        save(key, *impulseResponse);
+    }
+
+    const ScopedLock sl (lock);
+    insert(key, impulseResponse);
+    return impulseResponse;
+}
+
+void IrCache::setPersistenceDirectory(const File& directory, int64 maxDiskBytes)
+{
+    const ScopedLock sl (lock);
+    persistenceDirectory = directory;
+    this->maxDiskBytes = maxDiskBytes;
+    if (persistenceDirectory != File())
+        persistenceDirectory.createDirectory();
+}
+
+void IrCache::clear()
+{
+    const ScopedLock sl (lock);
+    entries.clear();
+    index.clear();
+    memoryUsage = 0;
+}
+
+size_t IrCache::getMemoryUsage() const
+{
+    const ScopedLock sl (lock);
+    return memoryUsage;
+}
+
+IrCache::ImpulseResponse IrCache::render(const Key& key)
+{
+    auto impulseResponse = std::make_shared<std::vector<float>>(key.length, 0.f);
+    if (key.length == 0)
+        return impulseResponse;
+
+    // with a sample rate of 1 the RT60 is in samples
+    Reverberator reverberator(key.dimension, key.powers);
+    reverberator.SetGain(key.gain);
+    reverberator.SetDecayTime((float)key.decaySamples, 1.0);
+    (*impulseResponse)[0] = 1.f;
+    reverberator.Reverberate(impulseResponse->data(), (unsigned)key.length, 1.f);
+    return impulseResponse;
+}
+
+void IrCache::insert(const Key& key, ImpulseResponse impulseResponse)
+{
+    if (index.find(key) != index.end())
+        return; // rendered by another caller at the same time
+
+    entries.emplace_front(key, impulseResponse);
+    index[key] = entries.begin();
+    memoryUsage += impulseResponse->size() * sizeof(float);
+
+    // the entry just added is never evicted, even if it is bigger than the limit on its own
+    while (memoryUsage > maxBytes && entries.size() > 1)
+    {
+        auto& oldest = entries.back();
+        memoryUsage -= oldest.second->size() * sizeof(float);
+        index.erase(oldest.first);
+        entries.pop_back();
+    }
+}
+
+File IrCache::getFileForKey(const Key& key) const
+{
+    return persistenceDirectory.getChildFile(String::toHexString((int64)key.getHash()) + ".fdnir");
+}
+
+IrCache::ImpulseResponse IrCache::load(const Key& key) const
+{
+    File file;
+    {
+        const ScopedLock sl (lock);
+        if (persistenceDirectory == File())
+            return nullptr;
+        file = getFileForKey(key);
+    }
+
+    MemoryBlock block;
+    if (! file.loadFileAsData(block))
+        return nullptr;
+
+    // the key is stored in the file as well, a hash collision is a cache miss then
+    MemoryInputStream stream (block, false);
+    if (stream.readInt() != FileMagic || stream.readByte() != FileVersion)
+        return nullptr;
+
+    Key storedKey;
+    storedKey.dimension = (Reverberator::FdnDimension)stream.readByte();
+    storedKey.powers.resize((size_t)stream.readByte());
+    for (auto &it : storedKey.powers)
+        it = stream.readByte();
+    storedKey.matrixType = (MatrixType)stream.readByte();
+    storedKey.decaySamples = stream.readInt();
+    storedKey.gain = stream.readFloat();
+    storedKey.length = stream.readInt();
+    if (! (storedKey == key) || stream.getNumBytesRemaining() != (int64)(key.length * sizeof(float)))
+        return nullptr;
+
+    auto impulseResponse = std::make_shared<std::vector<float>>(key.length);
+    stream.read(impulseResponse->data(), key.length * (int)sizeof(float)); // samples are stored in the native (little-endian) order
+    file.setLastModificationTime(Time::getCurrentTime()); // the eviction order of the files is the order of their use
+    return impulseResponse;
+}
+
+void IrCache::save(const Key& key, const std::vector<float>& impulseResponse) const
+{
+    File file;
+    {
+        const ScopedLock sl (lock);
+        if (persistenceDirectory == File())
+            return;
+        file = getFileForKey(key);
+    }
+
+    MemoryOutputStream stream;
+    stream.writeInt(FileMagic);
+    stream.writeByte((char)FileVersion);
+    stream.writeByte((char)key.dimension);
+    stream.writeByte((char)key.powers.size());
+    for (auto &it : key.powers)
+        stream.writeByte((char)it);
+    stream.writeByte((char)key.matrixType);
+    stream.writeInt(key.decaySamples);
+    stream.writeFloat(key.gain);
+    stream.writeInt(key.length);
+    stream.write(impulseResponse.data(), impulseResponse.size() * sizeof(float));
+
+    if (file.replaceWithData(stream.getData(), stream.getDataSize()))
+        evictFiles(file);
+}
+
+void IrCache::evictFiles(const File& keep) const
+{
+    File directory;
+    int64 maxDiskBytes;
+    {
+        const ScopedLock sl (lock);
+        directory = persistenceDirectory;
+        maxDiskBytes = this->maxDiskBytes;
+    }
+
+    // the same policy as in memory: the least recently used go first, the file just written stays
+    auto files = directory.findChildFiles(File::findFiles, false, "*.fdnir");
+    int64 diskUsage = 0;
+    for (auto &it : files)
+        diskUsage += it.getSize();
+    if (diskUsage <= maxDiskBytes)
+        return;
+
+    std::sort(files.begin(), files.end(), [](const File& a, const File& b)
+    {
+        return a.getLastModificationTime() < b.getLastModificationTime();
+    });
+    for (auto &it : files)
+    {
+        if (diskUsage <= maxDiskBytes)
+            break;
+        if (it == keep)
+            continue;
+        auto size = it.getSize();
+        if (it.deleteFile())
+            diskUsage -= size;
+    }
+}
@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    IrCache.h
+    Created: 20 Oct 2026 11:02:37am
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "vector"
+#include "list"
+#include "map"
+#include "tuple"
+
+#include "Reverberator.h"
+
+// LRU cache of rendered impulse responses, keyed by the network configuration.
+// The cache is limited by the memory it holds, and it can mirror every rendered IR into a directory,
+// so the same configuration is not rendered again in the next session either.
+// The directory has its own size limit, the least recently used files are deleted beyond it.
+// It is shared by all the editors of the process (use it through SharedResourcePointer<IrCache>).
+class IrCache
+{
+public:
+    enum class MatrixType
+    {
+        hadamard = 0
+    };
+
+    struct Key
+    {
+        Reverberator::FdnDimension dimension;
+        std::vector<int> powers;
+        MatrixType matrixType;
+        int decaySamples; // RT60 * sample rate, 0 if the decay is set by the gain only (see Reverberator::SetDecayTime())
+        float gain;
+        int length; // the render depends on the sample rate through decaySamples only
+
+        bool operator< (const Key& other) const;
+        bool operator== (const Key& other) const;
+        uint64 getHash() const;
+    };
+
+    using ImpulseResponse = std::shared_ptr<const std::vector<float>>;
+
+    IrCache(size_t maxBytes = DefaultMaxBytes);
+
+    ImpulseResponse getImpulseResponse(const Key& key); // renders the IR if it is neither in memory nor on disk
+    void setPersistenceDirectory(const File& directory, int64 maxDiskBytes = DefaultMaxDiskBytes); // File() switches the persistence off
+    void clear();
+    size_t getMemoryUsage() const;
+
+private:
+    static ImpulseResponse render(const Key& key);
+    File getFileForKey(const Key& key) const;
+    ImpulseResponse load(const Key& key) const;
+    void save(const Key& key, const std::vector<float>& impulseResponse) const;
+    void evictFiles(const File& keep) const;
+    void insert(const Key& key, ImpulseResponse impulseResponse);
+
+    CriticalSection lock;
+    std::list<std::pair<Key, ImpulseResponse>> entries; // the most recently used first
+    std::map<Key, std::list<std::pair<Key, ImpulseResponse>>::iterator> index;
+    size_t memoryUsage = 0;
+    const size_t maxBytes;
+    File persistenceDirectory;
+    int64 maxDiskBytes = DefaultMaxDiskBytes;
+
+    static const size_t DefaultMaxBytes = 64 * 1024 * 1024;
+    static const int64 DefaultMaxDiskBytes = 128 * 1024 * 1024;
+    static const int FileMagic = 0x49464446; // "FDFI"
+    static const int FileVersion = 3;
+
+    JUCE_DECLARE_NON_COPYABLE (IrCache)
+};
@@ -0,0 +1,163 @@
+/*
+  ==============================================================================
+
+    LowBandNetwork.cpp
+    Created: 24 Oct 2026 4:18:32pm
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#include "LowBandNetwork.h"
+
+void LowBandNetwork::Biquad::SetButterworth(double frequency, double sampleRate, bool highPass)
+{
+    // RBJ cookbook low/high pass with Q = 1 / sqrt(2)
+    auto w0 = 2.0 * MathConstants<double>::pi * frequency / sampleRate;
+    auto alpha = std::sin(w0) / std::sqrt(2.0);
+    auto cosW0 = std::cos(w0);
+    auto a0 = 1.0 + alpha;
+    auto b = highPass ? (1.0 + cosW0) / 2.0 : (1.0 - cosW0) / 2.0;
+    b0 = (float)(b / a0);
+    b1 = (float)((highPass ? -2.0 * b : 2.0 * b) / a0);
+    b2 = b0;
+    a1 = (float)(-2.0 * cosW0 / a0);
+    a2 = (float)((1.0 - alpha) / a0);
+}
+
+void LowBandNetwork::Biquad::Reset()
+{
+    z1.fill(0.f);
+    z2.fill(0.f);
+}
+
+void LowBandNetwork::Prepare(double sampleRate, int maxBlockLength, int numLanes)
+{
+    jassert(numLanes > 0 && numLanes <= MaxLanes);
+    if (network != nullptr && network->GetNumLanes() != numLanes)
+        network.reset(); // recreated by the next SetNetwork()
+
+    this->sampleRate = sampleRate;
+    this->numLanes = numLanes;
+    maxDecimatedLength = maxBlockLength / Decimation + 1;
+    decimatedInput.assign((size_t)(maxDecimatedLength * numLanes), 0.f);
+    decimatedOutput.assign((size_t)(maxDecimatedLength * numLanes), 0.f);
+    crossover = 0.f;
+    Reset();
+    if (network != nullptr)
+        network->Prepare(sampleRate / Decimation, maxDecimatedLength);
+}
+
+void LowBandNetwork::SetNetwork(Reverberator::FdnDimension dim, const std::vector<int>& powers)
+{
+    jassert((int)dim <= MaxDimension && powers.size() == (size_t)dim);
+    if (network == nullptr)
+    {
+        network.reset(new BatchReverberator(dim, powers, numLanes, FirstPrime));
+        network->SetDecayTime(decayTime, sampleRate / Decimation);
+        network->Prepare(sampleRate / Decimation, maxDecimatedLength);
+        return;
+    }
+    network->SetDimension(dim);
+    network->GenerateDelayValues(powers);
+}
+
+void LowBandNetwork::SetDecayTime(float rt60Seconds)
+{
+    decayTime = rt60Seconds;
+    if (network != nullptr)
+        network->SetDecayTime(decayTime, sampleRate / Decimation);
+}
+
+void LowBandNetwork::SetCrossover(float frequency)
+{
+    // kept below the Nyquist frequency of the decimated band
+    frequency = jmin(frequency, (float)(0.4 * sampleRate / Decimation));
+    if (frequency == crossover)
+        return;
+
+    for (auto &it : lowPass)
+        it.SetButterworth(frequency, sampleRate, false);
+    for (auto &it : highPass)
+        it.SetButterworth(frequency, sampleRate, true);
+    for (auto &it : interpolation)
+        it.SetButterworth(frequency, sampleRate, false);
+    crossover = frequency;
+}
+
+void LowBandNetwork::SetGain(float gain)
+{
+    if (network != nullptr)
+        network->SetGain(gain);
+}
+
+void LowBandNetwork::Reset()
+{
+    for (auto &it : lowPass)
+        it.Reset();
+    for (auto &it : highPass)
+        it.Reset();
+    for (auto &it : interpolation)
+        it.Reset();
+    if (network != nullptr)
+        network->Reset();
+    phase = 0;
+}
+
+void LowBandNetwork::Release()
+{
+    network.reset();
+    std::vector<float>().swap(decimatedInput);
+    std::vector<float>().swap(decimatedOutput);
+    maxDecimatedLength = 0;
+}
+
+void LowBandNetwork::Process(const float* const* inputs, float* const* highOutputs, float* const* lowWetOutputs, unsigned blockLength)
+{
+    jassert(network != nullptr && (int)blockLength < maxDecimatedLength * Decimation);
+
+    // split, every Decimation-th sample of the low band goes to the low network
+    auto decimatedLength = 0;
+    auto position = phase;
+    for (auto n = 0; n < (int)blockLength; ++n)
+    {
+        for (auto k = 0; k < numLanes; ++k)
+        {
+            auto x = inputs[k][n];
+            auto low = lowPass[1].Process(lowPass[0].Process(x, k), k);
+            highOutputs[k][n] = highPass[1].Process(highPass[0].Process(x, k), k);
+            if (position == 0)
+                decimatedInput[k * maxDecimatedLength + decimatedLength] = low;
+        }
+        if (position == 0)
+            ++decimatedLength;
+        if (++position == Decimation)
+            position = 0;
+    }
+
+    const float* lowInputs[MaxLanes] = {};
+    float* lowOutputs[MaxLanes] = {};
+    for (auto k = 0; k < numLanes; ++k)
+    {
+        lowInputs[k] = &decimatedInput[k * maxDecimatedLength];
+        lowOutputs[k] = &decimatedOutput[k * maxDecimatedLength];
+    }
+    network->Reverberate(lowInputs, lowOutputs, (unsigned)decimatedLength);
+
+    // zero stuffing back to the full rate, the gain makes up for the zeros
+    auto decimatedIdx = 0;
+    position = phase;
+    for (auto n = 0; n < (int)blockLength; ++n)
+    {
+        for (auto k = 0; k < numLanes; ++k)
+        {
+            auto x = (position == 0) ? (float)Decimation * lowOutputs[k][decimatedIdx] : 0.f;
+            lowWetOutputs[k][n] = interpolation[1].Process(interpolation[0].Process(x, k), k);
+        }
+        if (position == 0)
+            ++decimatedIdx;
+        if (++position == Decimation)
+            position = 0;
+    }
+    phase = position;
+}
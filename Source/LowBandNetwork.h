@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    LowBandNetwork.h
+    Created: 24 Oct 2026 4:18:32pm
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "array"
+#include "memory"
+#include "vector"
+
+#include "BatchReverberator.h"
+
+// The low band of the multiband mode. A Linkwitz-Riley crossover splits the input in two: the high band goes on
+// to the main network, the low band is decimated by Decimation and runs through a small network of its own,
+// with its own dimension, delays and gain. The low network costs 1 / Decimation of a full rate one, and
+// the same delays in samples are Decimation times longer in time, so the low modes are denser.
+// Its delays are powers of the primes after the ones a full network can use (from FirstPrime on), so the
+// modes of the two networks never line up whatever the powers.
+// The lanes are processed side by side like in BatchReverberator, the low band output is the wet signal only.
+class LowBandNetwork
+{
+public:
+    static const int MaxLanes = BatchReverberator::MaxLanes;
+    static const int Decimation = 4;
+    static const int MaxDimension = 8;
+    static const int FirstPrime = (int)Reverberator::FdnDimension::matrix16d;
+
+    void Prepare(double sampleRate, int maxBlockLength, int numLanes);
+    void SetNetwork(Reverberator::FdnDimension dim, const std::vector<int>& powers);
+    void SetCrossover(float frequency);
+    void SetGain(float gain); // per pass of the low rate network
+    void SetDecayTime(float rt60Seconds); // see Reverberator::SetDecayTime(), at the decimated rate
+    void Reset();
+    void Release(); // frees the network and the buffers until the next Prepare() and SetNetwork()
+
+    // inputs, highOutputs and lowWetOutputs hold numLanes pointers each, highOutputs may be the inputs
+    void Process(const float* const* inputs, float* const* highOutputs, float* const* lowWetOutputs, unsigned blockLength);
+
+private:
+    // transposed direct form II, one state per lane
+    struct Biquad
+    {
+        void SetButterworth(double frequency, double sampleRate, bool highPass);
+        void Reset();
+        inline float Process(float x, int lane)
+        {
+            auto y = b0 * x + z1[lane];
+            z1[lane] = b1 * x - a1 * y + z2[lane];
+            z2[lane] = b2 * x - a2 * y;
+            return y;
+        }
+
+        float b0 = 1.f, b1 = 0.f, b2 = 0.f, a1 = 0.f, a2 = 0.f;
+        std::array<float, MaxLanes> z1 {}, z2 {};
+    };
+
+    double sampleRate = 44100.0;
+    int numLanes = 1;
+    int maxDecimatedLength = 1;
+    int phase = 0; // the position within the decimation period, the same for the input and the output
+    float crossover = 0.f;
+    float decayTime = 0.f;
+
+    // two cascaded Butterworth sections make a 4th order Linkwitz-Riley filter, the low and the high band
+    // sum up to an allpass; the low pass also keeps the aliases out of the decimated band
+    std::array<Biquad, 2> lowPass, highPass;
+    std::array<Biquad, 2> interpolation; // removes the images of the zero stuffed low band output
+
+    std::unique_ptr<BatchReverberator> network;
+    std::vector<float> decimatedInput;  // [lane][time]
+    std::vector<float> decimatedOutput; // [lane][time]
+};
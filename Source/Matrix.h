@@ -11,66 +11,274 @@
 #pragma once
 
 #include "../JuceLibraryCode/JuceHeader.h"
+#include "algorithm"
+#include "cstdint"
+#include "cstdlib"
+#include "new"
 #include "vector"
 #include "utility"
 
+// A non-owning view of one row of a Matrix, valid until the matrix is reshaped.
+template <typename T> class MatrixRow
+{
+public:
+    MatrixRow(T* data, std::size_t size) : rowData(data), rowSize(size) {}
+
+    T* begin() const { return rowData; }
+    T* end() const { return rowData + rowSize; }
+    T* data() const { return rowData; }
+    std::size_t size() const { return rowSize; }
+    T& operator[](std::size_t col) const { return rowData[col]; }
+
+private:
+    T* rowData;
+    std::size_t rowSize;
+};
+
+// Hands out memory aligned to Alignment bytes, so the rows of a Matrix start on cache lines.
+template <typename T, std::size_t Alignment> class AlignedAllocator
+{
+public:
+    using value_type = T;
+    template <typename U> struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+    AlignedAllocator() = default;
+    template <typename U> AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    T* allocate(std::size_t n) {
+        // the pointer malloc returned is kept right before the aligned block
+        auto raw = std::malloc(n * sizeof(T) + Alignment);
+        if (raw == nullptr)
+            throw std::bad_alloc();
+        auto aligned = (reinterpret_cast<std::uintptr_t>(raw) + Alignment) & ~(std::uintptr_t)(Alignment - 1);
+        reinterpret_cast<void**>(aligned)[-1] = raw;
+        return reinterpret_cast<T*>(aligned);
+    };
+
+    void deallocate(T* p, std::size_t) {
+        if (p != nullptr)
+            std::free(reinterpret_cast<void**>(p)[-1]);
+    };
+
+    template <typename U> bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+    template <typename U> bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+// Row-major values in one buffer: every row starts on a 64-byte boundary, the columns are padded
+// with zeros up to the stride (except after ReshapeDiscarding() ).
 template <typename T> class Matrix
 {
 public:
+    static constexpr std::size_t Alignment = 64;
+
     Matrix(size_t rowsSize, size_t colsSize, T&& initVals) {
         Resize(rowsSize, colsSize, std::forward<T>(initVals));
     };
 
     Matrix(const std::initializer_list<std::initializer_list<T>>&& initVals) {
-        rowsSize = initVals.begin()->size();
-        colsSize = 0;
+        Reshape(initVals.size(), initVals.begin()->size());
+        std::size_t row = 0;
         for (auto &it : initVals)
         {
-            jassert(it.size() == rowsSize);
-            matrixVals.push_back(it);
-            ++colsSize;
+            jassert(it.size() == colsSize);
+            std::copy(it.begin(), it.end(), GetRowSpan(row++).begin());
         }
     };
 
+    // frees the memory as well
     void Clear() {
-        matrixVals.clear();
+        Storage().swap(matrixVals);
         rowsSize = 0;
         colsSize = 0;
+        stride = 0;
     };
 
     void Resize(size_t rowsSize, size_t colsSize, T&& initVals) {
-        Clear();
+        Reshape(rowsSize, colsSize);
+        for (std::size_t row = 0; row < rowsSize; ++row)
+            Fill(row, 0, colsSize, initVals);
+    };
+
+    // keeps the values that fit and the capacity, allocates exactly the new size only when it grows past it;
+    // the new values are zeros
+    void Reshape(size_t rowsSize, size_t colsSize) {
+        const auto newStride = GetStrideFor(colsSize);
+        const auto keptRows = std::min(rowsSize, this->rowsSize);
+        const auto keptCols = std::min(colsSize, this->colsSize);
+        const auto required = std::max(rowsSize * newStride, this->rowsSize * stride);
+        if (required > matrixVals.capacity())
+            matrixVals.reserve(required);
+        if (required > matrixVals.size())
+            matrixVals.resize(required);
+
+        // the rows move in place, away from the start when the stride grows and towards it when it shrinks
+        auto data = matrixVals.data();
+        if (newStride > stride)
+        {
+            for (auto row = keptRows; row-- > 0;)
+                std::copy_backward(data + row * stride, data + row * stride + keptCols, data + row * newStride + keptCols);
+        }
+        else if (newStride < stride)
+        {
+            for (std::size_t row = 0; row < keptRows; ++row)
+                std::copy(data + row * stride, data + row * stride + keptCols, data + row * newStride);
+        }
+        matrixVals.resize(rowsSize * newStride);
+
         this->rowsSize = rowsSize;
         this->colsSize = colsSize;
-        for (auto i = 0; i < rowsSize; ++i)
-            matrixVals.emplace_back(colsSize, std::forward<T>(initVals));
+        stride = newStride;
+        data = matrixVals.data();
+        for (std::size_t row = 0; row < rowsSize; ++row)
+            std::fill(data + row * stride + (row < keptRows ? keptCols : 0), data + (row + 1) * stride, T());
+    };
+
+    // like Reshape() without keeping anything: no value is moved or cleared, the padding included, the contents
+    // are whatever the memory held. The buffer never shrinks, so any shape up to the largest one so far is free
+    void ReshapeDiscarding(size_t rowsSize, size_t colsSize) {
+        const auto newStride = GetStrideFor(colsSize);
+        const auto required = rowsSize * newStride;
+        if (required > matrixVals.capacity())
+            Storage(required).swap(matrixVals); // nothing to copy over
+        else if (required > matrixVals.size())
+            matrixVals.resize(required);
+
+        this->rowsSize = rowsSize;
+        this->colsSize = colsSize;
+        stride = newStride;
+    };
+
+    void Fill(std::size_t row, std::size_t fromCol, std::size_t toCol, const T& val) {
+        std::fill(matrixVals.data() + row * stride + fromCol, matrixVals.data() + row * stride + toCol, val);
     };
 
     void Set(std::size_t row, std::size_t col, const T&& val) {
-        matrixVals[row][col] = std::forward<const T>(val);
+        matrixVals[row * stride + col] = std::forward<const T>(val);
     };
 
     void SetRow(std::size_t row, std::vector<T>&& rowVal) {
         jassert(rowVal.size() == colsSize);
-        matrixVals[row] = rowVal;
+        std::copy(rowVal.begin(), rowVal.end(), GetRowSpan(row).begin());
     };
 
     T Get(std::size_t row, std::size_t col) const {
-        return matrixVals[row][col];
+        return matrixVals[row * stride + col];
     };
 
     std::vector<T> GetRow(std::size_t row) const {
-        return matrixVals[row];
+        auto span = GetRowSpan(row);
+        return std::vector<T>(span.begin(), span.end());
+    };
+
+    MatrixRow<T> GetRowSpan(std::size_t row) {
+        return MatrixRow<T>(matrixVals.data() + row * stride, colsSize);
+    };
+
+    MatrixRow<const T> GetRowSpan(std::size_t row) const {
+        return MatrixRow<const T>(matrixVals.data() + row * stride, colsSize);
     };
 
     std::pair<std::size_t, std::size_t> GetDimensions() const {
         return std::make_pair(rowsSize, colsSize);
     };
 
+    // the distance between the starts of two rows, in values
+    std::size_t GetStride() const {
+        return stride;
+    };
+
+    std::size_t GetMemoryBytes() const {
+        return matrixVals.capacity() * sizeof(T);
+    };
+
+    // result = M * vector, vector has colsSize values and result rowsSize, they must not overlap
+    void Multiply(const T* vector, T* result) const {
+        if (rowsSize == colsSize)
+        {
+            // the sizes of the networks, unrolled by the compiler
+            switch (colsSize)
+            {
+                case 2:  MultiplyFixed<2>(vector, result); return;
+                case 4:  MultiplyFixed<4>(vector, result); return;
+                case 8:  MultiplyFixed<8>(vector, result); return;
+                case 16: MultiplyFixed<16>(vector, result); return;
+                default: break;
+            }
+        }
+        for (std::size_t row = 0; row < rowsSize; ++row)
+        {
+            const T* rowVals = matrixVals.data() + row * stride;
+            T sum = T();
+            for (std::size_t col = 0; col < colsSize; ++col)
+                sum += rowVals[col] * vector[col];
+            result[row] = sum;
+        }
+    };
+
+    // outputs[row][n] = sum of M[row][col] * inputs[col][n] over the columns, the channels must not overlap
+    void MultiplyBlock(const T* const* inputs, T* const* outputs, std::size_t numSamples) const {
+        for (std::size_t row = 0; row < rowsSize; ++row)
+        {
+            const T* rowVals = matrixVals.data() + row * stride;
+            if (colsSize == 0)
+                std::fill(outputs[row], outputs[row] + numSamples, T());
+            else
+                MultiplyChannel(outputs[row], inputs[0], rowVals[0], numSamples);
+            for (std::size_t col = 1; col < colsSize; ++col)
+                AddWithMultiplyChannel(outputs[row], inputs[col], rowVals[col], numSamples);
+        }
+    };
+
+    static constexpr std::size_t GetStrideFor(std::size_t colsSize) {
+        return (colsSize + ValuesPerAlignment - 1) / ValuesPerAlignment * ValuesPerAlignment;
+    };
+
 protected:
-    std::vector<std::vector<T>> matrixVals;
+    using Storage = std::vector<T, AlignedAllocator<T, Alignment>>;
+    static constexpr std::size_t ValuesPerAlignment = (sizeof(T) < Alignment) ? Alignment / sizeof(T) : 1;
+
+    T& At(std::size_t row, std::size_t col) {
+        return matrixVals[row * stride + col];
+    };
+
+    Storage matrixVals;
     std::size_t rowsSize = 0;
     std::size_t colsSize = 0;
+    std::size_t stride = 0;
+
+private:
+    template <std::size_t N> void MultiplyFixed(const T* vector, T* result) const {
+        // the stride is a constant here as well
+        constexpr std::size_t fixedStride = GetStrideFor(N);
+        jassert(stride == fixedStride);
+        const T* rowVals = matrixVals.data();
+        for (std::size_t row = 0; row < N; ++row, rowVals += fixedStride)
+        {
+            T sum = T();
+            for (std::size_t col = 0; col < N; ++col)
+                sum += rowVals[col] * vector[col];
+            result[row] = sum;
+        }
+    };
+
+    // the float blocks go through the SIMD routines of JUCE
+    static void MultiplyChannel(float* dest, const float* src, float multiplier, std::size_t n) {
+        FloatVectorOperations::copyWithMultiply(dest, src, multiplier, (int)n);
+    };
+
+    static void AddWithMultiplyChannel(float* dest, const float* src, float multiplier, std::size_t n) {
+        FloatVectorOperations::addWithMultiply(dest, src, multiplier, (int)n);
+    };
+
+    template <typename U> static void MultiplyChannel(U* dest, const U* src, U multiplier, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i)
+            dest[i] = src[i] * multiplier;
+    };
+
+    template <typename U> static void AddWithMultiplyChannel(U* dest, const U* src, U multiplier, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i)
+            dest[i] += src[i] * multiplier;
+    };
 };
 
 
@@ -85,7 +293,7 @@ public:
 private:
     void FillMatrix(std::size_t dimension, float gain) {
         if (dimension == 1)
-            matrixVals[0][0] =  1.0f * gain;
+            At(0, 0) =  1.0f * gain;
         else
         {
             std::size_t halfDimension = dimension / 2;
@@ -93,13 +301,13 @@ private:
 
             for (auto i = halfDimension; i < dimension; ++i)
                 for (auto j = 0; j < halfDimension; ++j)
-                    matrixVals[i][j] = matrixVals[i - halfDimension][j];
+                    At(i, j) = At(i - halfDimension, j);
             for (auto i = 0; i < halfDimension; ++i)
                 for (auto j = halfDimension; j < dimension; ++j)
-                    matrixVals[i][j] = matrixVals[i][j - halfDimension];
+                    At(i, j) = At(i, j - halfDimension);
             for (auto i = halfDimension; i < dimension; ++i)
                 for (auto j = halfDimension; j < dimension; ++j)
-                    matrixVals[i][j] = -matrixVals[i - halfDimension][j - halfDimension];
+                    At(i, j) = -At(i - halfDimension, j - halfDimension);
         }
     }
 };
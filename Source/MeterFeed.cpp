@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+    MeterFeed.cpp
+    Created: 19 Oct 2026 4:05:51pm
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#include "MeterFeed.h"
+
+MeterFeed::MeterFeed() :
+        levelsFifo(LevelsCapacity),
+        levelsData(LevelsCapacity),
+        wetFifo(WetCapacity),
+        wetData(WetCapacity, 0.f),
+        accumulated(),
+        sumOfSquares()
+{
+}
+
+void MeterFeed::prepare(double sampleRate)
+{
+    samplesPerLevel = jmax(1, (int)(sampleRate / LevelsRateHz));
+    accumulated = Levels();
+    std::fill(sumOfSquares, sumOfSquares + MaxChannels, 0.f);
+    accumulatedSamples = 0;
+}
+
+void MeterFeed::setActive(bool shouldBeActive)
+{
+    active.store(shouldBeActive);
+}
+
+bool MeterFeed::isActive() const
+{
+    return active.load(std::memory_order_relaxed);
+}
+
+void MeterFeed::pushOutput(const AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    if (! isActive())
+        return;
+
+    auto numChannels = jmin(MaxChannels, buffer.getNumChannels());
+    for (auto channel = 0; channel < numChannels; ++channel)
+    {
+        auto rms = buffer.getRMSLevel(channel, startSample, numSamples);
+        accumulated.peak[channel] = jmax(accumulated.peak[channel], buffer.getMagnitude(channel, startSample, numSamples));
+        sumOfSquares[channel] += rms * rms * (float)numSamples;
+    }
+    accumulatedSamples += numSamples;
+
+    if (accumulatedSamples < samplesPerLevel)
+        return;
+
+    for (auto channel = 0; channel < MaxChannels; ++channel)
+        accumulated.rms[channel] = std::sqrt(sumOfSquares[channel] / (float)accumulatedSamples);
+
+    // a full fifo means nobody reads, the levels are dropped then
+    int start1, size1, start2, size2;
+    levelsFifo.prepareToWrite(1, start1, size1, start2, size2);
+    if (size1 > 0)
+        levelsData[start1] = accumulated;
+    levelsFifo.finishedWrite(size1);
+
+    accumulated = Levels();
+    std::fill(sumOfSquares, sumOfSquares + MaxChannels, 0.f);
+    accumulatedSamples = 0;
+}
+
+void MeterFeed::pushWet(const float* wet, int numSamples)
+{
+    if (! isActive())
+        return;
+
+    int start1, size1, start2, size2;
+    wetFifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+    std::copy(wet, wet + size1, wetData.begin() + start1);
+    std::copy(wet + size1, wet + size1 + size2, wetData.begin() + start2);
+    wetFifo.finishedWrite(size1 + size2);
+}
+
+bool MeterFeed::popLevels(Levels& levels)
+{
+    auto numReady = levelsFifo.getNumReady();
+    if (numReady == 0)
+        return false;
+
+    int start1, size1, start2, size2;
+    levelsFifo.prepareToRead(numReady, start1, size1, start2, size2);
+    levels = (size2 > 0) ? levelsData[start2 + size2 - 1] : levelsData[start1 + size1 - 1];
+    levelsFifo.finishedRead(size1 + size2);
+    return true;
+}
+
+int MeterFeed::popWet(float* destination, int maxSamples)
+{
+    int start1, size1, start2, size2;
+    wetFifo.prepareToRead(maxSamples, start1, size1, start2, size2);
+    std::copy(wetData.begin() + start1, wetData.begin() + start1 + size1, destination);
+    std::copy(wetData.begin() + start2, wetData.begin() + start2 + size2, destination + size1);
+    wetFifo.finishedRead(size1 + size2);
+    return size1 + size2;
+}
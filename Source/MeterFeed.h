@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    MeterFeed.h
+    Created: 19 Oct 2026 4:05:51pm
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "atomic"
+#include "vector"
+
+// Output levels and the wet signal passed from the audio thread to the editor.
+// Both streams are single-producer/single-consumer AbstractFifos: the audio thread never blocks
+// or allocates, and it pushes nothing at all while no editor is listening (see setActive()).
+class MeterFeed
+{
+public:
+    static const int MaxChannels = 2;
+
+    struct Levels
+    {
+        float peak[MaxChannels];
+        float rms[MaxChannels];
+    };
+
+    MeterFeed();
+
+    void prepare(double sampleRate);
+    void setActive(bool shouldBeActive);
+    bool isActive() const;
+
+    // audio thread
+    void pushOutput(const AudioBuffer<float>& buffer, int startSample, int numSamples);
+    void pushWet(const float* wet, int numSamples);
+
+    // message thread
+    bool popLevels(Levels& levels); // the latest levels only, the older ones are skipped
+    int popWet(float* destination, int maxSamples);
+
+private:
+    std::atomic<bool> active { false };
+
+    AbstractFifo levelsFifo;
+    std::vector<Levels> levelsData;
+    AbstractFifo wetFifo;
+    std::vector<float> wetData;
+
+    Levels accumulated;
+    float sumOfSquares[MaxChannels];
+    int accumulatedSamples = 0;
+    int samplesPerLevel = 1024;
+
+    const double LevelsRateHz = 60.0;
+    static const int LevelsCapacity = 64;
+    static const int WetCapacity = 1 << 14;
+
+    JUCE_DECLARE_NON_COPYABLE (MeterFeed)
+};
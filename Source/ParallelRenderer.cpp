@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+    ParallelRenderer.cpp
+    Created: 26 Oct 2026 11:15:24am
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#include "ParallelRenderer.h"
+#include "atomic"
+#include "thread"
+
+class ParallelRenderer::Worker
+{
+public:
+    Worker(const ParallelRenderer& owner, std::atomic<int>& nextSegment) :
+            owner(owner),
+            nextSegment(nextSegment),
+            reverberator(owner.dimension, owner.powers)
+    {
+        reverberator.SetGain(owner.settings.gain);
+        reverberator.SetDecayTime(owner.settings.decayTime, owner.settings.sampleRate);
+
+        // the state is checked once per tail block, every sample of it has been read and rewritten by then
+        auto maxDelay = Reverberator::CalculateDelayValues(owner.powers).back();
+        silence.assign((size_t)jmax(MinTailBlockLength, maxDelay), 0.f);
+    }
+
+    void run(const float* input, float* wetOutput, int64 numSamples, std::vector<std::vector<float>>& tails)
+    {
+        const auto numSegments = (int)tails.size();
+        const auto threshold = owner.settings.tolerance * owner.settings.tolerance;
+        for (;;)
+        {
+            auto segment = nextSegment.fetch_add(1);
+            if (segment >= numSegments)
+                return;
+
+            // the segments do not overlap, so the zero-state response goes straight to the output
+            auto start = segment * owner.segmentLength;
+            auto length = jmin(owner.segmentLength, numSamples - start);
+            reverberator.Reset();
+            reverberator.Reverberate(input + start, wetOutput + start, (unsigned)length);
+
+            auto& tail = tails[segment];
+            tail.clear();
+            auto remaining = numSamples - start - length;
+            while (remaining > 0 && reverberator.GetStateEnergy() > threshold)
+            {
+                auto blockLength = (int)jmin((int64)silence.size(), remaining);
+                tail.resize(tail.size() + blockLength);
+                reverberator.Reverberate(silence.data(), tail.data() + tail.size() - blockLength, (unsigned)blockLength);
+                remaining -= blockLength;
+            }
+        }
+    }
+
+private:
+    const ParallelRenderer& owner;
+    std::atomic<int>& nextSegment;
+
+    Reverberator reverberator;
+    std::vector<float> silence;
+
+    static const int MinTailBlockLength = 4096;
+};
+
+ParallelRenderer::ParallelRenderer(Reverberator::FdnDimension dim, const std::vector<int>& powers, const Settings& settings) :
+        dimension(dim),
+        powers(powers),
+        settings(settings),
+        segmentLength(jmax((int64)1, (int64)(settings.segmentSeconds * settings.sampleRate)))
+{
+    jassert(powers.size() == (size_t)dim);
+}
+
+int ParallelRenderer::getNumSegments(int64 numSamples) const
+{
+    return (int)((numSamples + segmentLength - 1) / segmentLength);
+}
+
+void ParallelRenderer::render(const float* input, float* wetOutput, int64 numSamples)
+{
+    auto numSegments = getNumSegments(numSamples);
+    auto numThreads = (settings.numThreads > 0) ? settings.numThreads : jmax(1, (int)std::thread::hardware_concurrency());
+    numThreads = jmin(numThreads, jmax(1, numSegments));
+
+    std::atomic<int> nextSegment { 0 };
+    std::vector<std::vector<float>> tails ((size_t)numSegments);
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (auto i = 0; i < numThreads; ++i)
+        workers.emplace_back(new Worker(*this, nextSegment));
+
+    std::vector<std::thread> threads;
+    for (auto &it : workers)
+        threads.emplace_back([&it, input, wetOutput, numSamples, &tails]() { it->run(input, wetOutput, numSamples, tails); });
+    for (auto &it : threads)
+        it.join();
+
+    // a tail can reach over several segments and over the next tails, so they are added after all the segments
+    for (auto segment = 0; segment < numSegments; ++segment)
+    {
+        auto tailStart = jmin(numSamples, (segment + 1) * segmentLength);
+        auto& tail = tails[segment];
+        FloatVectorOperations::add(wetOutput + tailStart, tail.data(), (int)tail.size());
+    }
+}
@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    ParallelRenderer.h
+    Created: 26 Oct 2026 11:15:24am
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "vector"
+
+#include "Reverberator.h"
+
+// Renders the wet signal of one long input on all the cores. The network is linear and time-invariant
+// (the feedback modulation is not used here), so its output is the sum of its responses to every segment
+// of the input: each segment is rendered from silence by its own worker, the free response that follows it
+// (its tail) is rendered until the state of the network drops below the tolerance and is then added over
+// the next segments. The extra cost over a sequential render is one tail per segment.
+class ParallelRenderer
+{
+public:
+    struct Settings
+    {
+        float gain = 1.f;
+        float decayTime = 0.f; // RT60 in seconds, see Reverberator::SetDecayTime()
+        double sampleRate = 44100.0;
+        double segmentSeconds = 30.0;
+        int numThreads = 0; // 0 uses all the cores
+        float tolerance = 1e-6f; // the tail is cut once the norm of the network state is below it
+    };
+
+    ParallelRenderer(Reverberator::FdnDimension dim, const std::vector<int>& powers, const Settings& settings);
+
+    // the same as Reverberator::Reverberate(input, wetOutput, numSamples) from silence, within the tolerance
+    void render(const float* input, float* wetOutput, int64 numSamples);
+    int getNumSegments(int64 numSamples) const;
+
+private:
+    class Worker;
+
+    const Reverberator::FdnDimension dimension;
+    const std::vector<int> powers;
+    const Settings settings;
+    const int64 segmentLength;
+};
@@ -4,27 +4,224 @@
 //==============================================================================
 //InfoComponent methods
 
+// takes the IR from the cache (rendering it there on a miss) and analyses it block by block,
+// the cached IR is longer than the plot, the plot is its beginning
+// the intermediate results are published every few blocks so the panel fills in while the tail is still analysed
+class InfoComponent::AnalysisJob : public ThreadPoolJob
+{
+public:
+    AnalysisJob(InfoComponent& owner, const IrCache::Key& key, double sampleRate) :
+            ThreadPoolJob("IR analysis"),
+            owner(owner),
+            key(key),
+            analyser(sampleRate, key.length)
+    {
+    }
+    
+    JobStatus runJob() override
+    {
+        FDN_TRACE_SCOPE("InfoComponent::AnalysisJob");
+        auto impulseResponse = owner.irCache->getImpulseResponse(key);
+        {
+            const ScopedLock sl (owner.analysisLock);
+            owner.pendingImpulseResponse = impulseResponse;
+        }
+        
+        for (auto start = 0, blockIdx = 0; start < key.length && ! shouldExit(); start += BlockLength, ++blockIdx)
+        {
+            auto blockLength = jmin(BlockLength, key.length - start);
+            analyser.addBlock(impulseResponse->data() + start, blockLength);
+            
+            if ((blockIdx + 1) % BlocksPerUpdate == 0 || start + blockLength == key.length)
+            {
+                std::unique_ptr<IrAnalyser::Results> results (new IrAnalyser::Results(analyser.getResults()));
+                const ScopedLock sl (owner.analysisLock);
+                owner.pendingAnalysis = std::move(results);
+            }
+        }
+        return jobHasFinished;
+    }
+    
+private:
+    InfoComponent& owner;
+    const IrCache::Key key;
+    IrAnalyser analyser;
+    
+    static const int BlockLength = 4096;
+    static const int BlocksPerUpdate = 8;
+};
 
-InfoComponent::InfoComponent() : SamplesQuantity((int)data.size())
+
+InfoComponent::InfoComponent() :
+        SamplesQuantity((int)data.size()),
+        fft(FftOrder),
+        window(FftSize, dsp::WindowingFunction<float>::hann)
 {
     infoLabel.setJustificationType(Justification::topLeft);
     addAndMakeVisible(infoLabel);
+    spectrum.fill(-100.0f);
+    irCache->setPersistenceDirectory(File::getSpecialLocation(File::userApplicationDataDirectory).getChildFile("FdnReverberation").getChildFile("IrCache"));
+}
+
+InfoComponent::~InfoComponent()
+{
+    // the job writes to the members below the pool, it has to be stopped before they are gone
+    analysisPool.removeAllJobs(true, 1000);
+    setMeterFeed(nullptr);
 }
 
 void InfoComponent::paint (Graphics& g)
 {
+    FDN_TRACE_SCOPE("InfoComponent::paint");
     g.setColour(Colours::whitesmoke);
     if (toShowIR)
         drawData(g);
+    if (toShowIR && hasAnalysis)
+        drawAnalysis(g);
+    if (meterFeed != nullptr)
+        drawMeters(g);
 }
 
 void InfoComponent::resized()
 {
     auto r = getLocalBounds();
-    infoLabel.setBounds(20, 20, r.getWidth() - 40, r.getHeight() - 40);
+    infoLabel.setBounds(20, 20, r.getWidth() - 40, r.getHeight() - 40 - MetersHeight);
     repaint();
 }
 
+void InfoComponent::setMeterFeed (MeterFeed* feed)
+{
+    // the processor pushes the levels only while somebody is listening
+    if (meterFeed != nullptr)
+        meterFeed->setActive(false);
+    meterFeed = feed;
+    
+    if (meterFeed != nullptr)
+    {
+        meterFeed->setActive(true);
+        startTimerHz(30);
+    }
+    else
+        stopTimer();
+}
+
+void InfoComponent::timerCallback()
+{
+    updateAnalysis();
+    if (meterFeed == nullptr)
+        return;
+    
+    MeterFeed::Levels newLevels;
+    auto hasNewLevels = meterFeed->popLevels(newLevels);
+    for (auto channel = 0; channel < MeterFeed::MaxChannels; ++channel)
+    {
+        levels.peak[channel] = jmax(levels.peak[channel] * LevelsDecay, hasNewLevels ? newLevels.peak[channel] : 0.0f);
+        levels.rms[channel] = jmax(levels.rms[channel] * LevelsDecay, hasNewLevels ? newLevels.rms[channel] : 0.0f);
+    }
+    
+    updateSpectrum();
+    repaint(getMetersBounds());
+}
+
+void InfoComponent::updateAnalysis ()
+{
+    std::unique_ptr<IrAnalyser::Results> newAnalysis;
+    IrCache::ImpulseResponse newImpulseResponse;
+    {
+        const ScopedLock sl (analysisLock);
+        newAnalysis = std::move(pendingAnalysis);
+        newImpulseResponse = std::move(pendingImpulseResponse);
+    }
+    if (newAnalysis == nullptr && newImpulseResponse == nullptr)
+        return;
+    
+    if (newImpulseResponse != nullptr)
+    {
+        auto plotLength = jmin(newImpulseResponse->size(), data.size());
+        std::copy(newImpulseResponse->begin(), newImpulseResponse->begin() + (std::ptrdiff_t)plotLength, data.begin());
+        std::fill(data.begin() + (std::ptrdiff_t)plotLength, data.end(), 0.f);
+    }
+    if (newAnalysis != nullptr)
+    {
+        analysis = std::move(*newAnalysis);
+        hasAnalysis = true;
+    }
+    if (toShowIR)
+        repaint();
+}
+
+void InfoComponent::drawAnalysis (Graphics& g)
+{
+    auto r = getLocalBounds().withTrimmedBottom(MetersHeight).removeFromRight(180).reduced(30, 20);
+    
+    String text;
+    for (auto band = 0; band < IrAnalyser::NumBands; ++band)
+    {
+        auto frequency = IrAnalyser::getBandCentreFrequency(band);
+        auto frequencyText = (frequency < 1000.f) ? String(roundToInt(frequency)) : String(roundToInt(frequency / 1000.f)) + "k";
+        text << "RT60 " << frequencyText << " Hz: " << ((analysis.rt60[band] > 0.f) ? String(analysis.rt60[band], 2) + " s" : String("-")) << "\n";
+    }
+    text << "RT60: " << ((analysis.broadbandRt60 > 0.f) ? String(analysis.broadbandRt60, 2) + " s" : String("-")) << "\n";
+    text << "Echo density build-up: " << ((analysis.echoDensityBuildUpSeconds > 0.f) ? String(analysis.echoDensityBuildUpSeconds * 1000.f, 0) + " ms" : String("-")) << "\n";
+    
+    g.setFont(13.0f);
+    g.drawFittedText(text, r, Justification::topRight, IrAnalyser::NumBands + 2);
+}
+
+void InfoComponent::updateSpectrum ()
+{
+    // the spectrum is updated once per full FFT frame, the samples beyond the frame are read on the next tick
+    wetSamplesQuantity += meterFeed->popWet(wetSamples.data() + wetSamplesQuantity, FftSize - wetSamplesQuantity);
+    if (wetSamplesQuantity < FftSize)
+        return;
+    
+    std::copy(wetSamples.begin(), wetSamples.end(), fftData.begin());
+    window.multiplyWithWindowingTable(fftData.data(), FftSize);
+    fft.performFrequencyOnlyForwardTransform(fftData.data());
+    for (auto i = 0; i < (int)spectrum.size(); ++i)
+        spectrum[i] = Decibels::gainToDecibels(fftData[i] / (float)FftSize);
+    wetSamplesQuantity = 0;
+}
+
+Rectangle<int> InfoComponent::getMetersBounds () const
+{
+    return getLocalBounds().removeFromBottom(MetersHeight).reduced(10);
+}
+
+void InfoComponent::drawMeters (Graphics& g)
+{
+    auto r = getMetersBounds();
+    auto metersArea = r.removeFromLeft(40);
+    auto barWidth = metersArea.getWidth() / MeterFeed::MaxChannels;
+    
+    for (auto channel = 0; channel < MeterFeed::MaxChannels; ++channel)
+    {
+        auto bar = metersArea.withWidth(barWidth - 4).withX(metersArea.getX() + channel * barWidth);
+        auto toHeight = [&bar](float gain) { return bar.getHeight() * jlimit(0.0f, 1.0f, (Decibels::gainToDecibels(gain) + 60.0f) / 60.0f); };
+        g.setColour(Colours::grey);
+        g.fillRect(bar.withTop(bar.getBottom() - (int)toHeight(levels.rms[channel])));
+        g.setColour(Colours::whitesmoke);
+        auto peakY = (float)bar.getBottom() - toHeight(levels.peak[channel]);
+        g.drawLine((float)bar.getX(), peakY, (float)bar.getRight(), peakY);
+    }
+    
+    // log-frequency spectrum of the wet signal, -100..0 dB
+    auto spectrumArea = r.withTrimmedLeft(10).toFloat();
+    g.setColour(Colours::whitesmoke);
+    g.drawRect(spectrumArea);
+    Path spectrumPath;
+    for (auto i = 1; i < (int)spectrum.size(); ++i)
+    {
+        auto x = spectrumArea.getX() + spectrumArea.getWidth() * std::log((float)i) / std::log((float)spectrum.size());
+        auto y = spectrumArea.getBottom() - spectrumArea.getHeight() * jlimit(0.0f, 1.0f, (spectrum[i] + 100.0f) / 100.0f);
+        if (i == 1)
+            spectrumPath.startNewSubPath(x, y);
+        else
+            spectrumPath.lineTo(x, y);
+    }
+    g.strokePath(spectrumPath, PathStrokeType(1.0f));
+}
+
 void InfoComponent::showInfo (const String& str)
 {
     if (str != "")
@@ -33,24 +230,32 @@ void InfoComponent::showInfo (const String& str)
     repaint();
 }
 
-void InfoComponent::showIR (Reverberator::FdnDimension dimension, const std::vector<int>& delays)
+void InfoComponent::showIR (Reverberator::FdnDimension dimension, const std::vector<int>& delays, double sampleRate, float decayTimeSeconds, float gain)
 {
+    FDN_TRACE_SCOPE("InfoComponent::showIR");
     infoLabel.setText("", dontSendNotification);
-    std::vector<int> localDelays = delays;
-    Reverberator reverbToShowIR = Reverberator(dimension, localDelays);
-    reverbToShowIR.Reverberate(setPulse(), SamplesQuantity, 1);
+    
+    // one IR serves both the analysis and the plot, it is looked up (or rendered) in the background
+    auto length = jmax(SamplesQuantity, roundToInt(AnalysisSeconds * sampleRate));
+    IrCache::Key key { dimension, delays, IrCache::MatrixType::hadamard, roundToInt(decayTimeSeconds * sampleRate), gain, length };
+    
+    // the previous IR and analysis are of no use any more, the plot stays flat until the new IR is there
+    analysisPool.removeAllJobs(true, 1000);
+    {
+        const ScopedLock sl (analysisLock);
+        pendingAnalysis.reset();
+        pendingImpulseResponse.reset();
+    }
+    hasAnalysis = false;
+    data.fill(0.f);
+    analysisPool.addJob(new AnalysisJob(*this, key, sampleRate), true);
+    if (! isTimerRunning())
+        startTimerHz(30);
     
     toShowIR = true;
     repaint();
 }
 
-float* InfoComponent::setPulse ()
-{
-    data.fill(0.0f);
-    data[0] = 1.0f;
-    return data.data();
-}
-
 std::pair<float, float> InfoComponent::findDataBoundaries ()
 {
     auto minVal = data[0];
@@ -65,7 +270,7 @@ std::pair<float, float> InfoComponent::findDataBoundaries ()
 
 void InfoComponent::drawData (Graphics& g)
 {
-    auto r = getLocalBounds();
+    auto r = getLocalBounds().withTrimmedBottom(MetersHeight);
     using bounds_t = decltype(r.getWidth());
     
     auto minmaxVal = findDataBoundaries();
@@ -327,7 +532,8 @@ AdditionalComponent::AdditionalComponent(FdnReverberationNewAudioProcessor& proc
     AuxComponent(processor, msgListener, infoComp),
     saveButton("Save Preset", std::bind(&InfoComponent::showInfo, &infoComp, std::placeholders::_1), "Save all parameters as a preset"),
     showIrButton("Show IR", std::bind(&InfoComponent::showInfo, &infoComp, std::placeholders::_1), "Show Impulse Response for the chosen parameters (press 'Apply' before)"),
-    drywetSlider(Slider::RotaryVerticalDrag, Slider::TextEntryBoxPosition::TextBoxBelow, std::bind(&InfoComponent::showInfo, &infoComp, std::placeholders::_1), "Set dry/wet ratio")
+    drywetSlider(Slider::RotaryVerticalDrag, Slider::TextEntryBoxPosition::TextBoxBelow, std::bind(&InfoComponent::showInfo, &infoComp, std::placeholders::_1), "Set dry/wet ratio"),
+    decaySlider(Slider::RotaryVerticalDrag, Slider::TextEntryBoxPosition::TextBoxBelow, std::bind(&InfoComponent::showInfo, &infoComp, std::placeholders::_1), "Set the feedback gain (the longer decay the closer to 1)")
 {
     addAndMakeVisible(saveButton);
     saveButton.onClick = [this]() {savePreset();};
@@ -336,9 +542,10 @@ AdditionalComponent::AdditionalComponent(FdnReverberationNewAudioProcessor& proc
     showIrButton.onClick = [this]() {showIR();};
     
     addAndMakeVisible(drywetSlider);
-    drywetSlider.setRange(0, 100, 1);
-    drywetSlider.setValue(50);
-    drywetSlider.onValueChange = [this]() { this->processor.setDryWet((float)drywetSlider.getValue() / 100.0f); };
+    drywetAttachment.reset(new AudioProcessorValueTreeState::SliderAttachment(processor.getParameters(), "drywet", drywetSlider));
+    
+    addAndMakeVisible(decaySlider);
+    decayAttachment.reset(new AudioProcessorValueTreeState::SliderAttachment(processor.getParameters(), "decay", decaySlider));
 }
 
 
@@ -352,15 +559,16 @@ void AdditionalComponent::resized()
     auto r = getLocalBounds();
     using bounds_t = decltype(r.getWidth());
     
-    bounds_t compomentWidth = r.getWidth() / 3;
+    bounds_t compomentWidth = r.getWidth() / 4;
     bounds_t centeredHeight = r.getHeight() / 2;
     bounds_t buttonHeigth = std::min(40, r.getHeight());
     bounds_t buttonWidth = std::min(100, compomentWidth);
     bounds_t sliderSize = std::min({120, compomentWidth, r.getHeight()});
     
     showIrButton.setBounds(compomentWidth / 2 - buttonWidth / 2, centeredHeight - buttonHeigth / 2, buttonWidth, buttonHeigth);
-    saveButton.setBounds(2 * compomentWidth + compomentWidth / 2 - buttonWidth / 2, centeredHeight - buttonHeigth / 2, buttonWidth, buttonHeigth);
+    saveButton.setBounds(3 * compomentWidth + compomentWidth / 2 - buttonWidth / 2, centeredHeight - buttonHeigth / 2, buttonWidth, buttonHeigth);
     drywetSlider.setBounds(compomentWidth + compomentWidth / 2 - sliderSize / 2, centeredHeight - sliderSize / 2, sliderSize, sliderSize);
+    decaySlider.setBounds(2 * compomentWidth + compomentWidth / 2 - sliderSize / 2, centeredHeight - sliderSize / 2, sliderSize, sliderSize);
 }
 
 void AdditionalComponent::savePreset()
@@ -370,7 +578,11 @@ void AdditionalComponent::savePreset()
 
 void AdditionalComponent::showIR()
 {
-    infoComp.showIR(processor.getDimension(), processor.getDelayPowers());
+    // the plot shows what the network plays, with the decay set by the parameters
+    auto sampleRate = (processor.getSampleRate() > 0) ? processor.getSampleRate() : 44100.0;
+    auto& parameters = processor.getParameters();
+    infoComp.showIR(processor.getDimension(), processor.getDelayPowers(), sampleRate,
+                    *parameters.getRawParameterValue("decaytime"), *parameters.getRawParameterValue("decay"));
 }
 
 //==============================================================================
@@ -469,7 +681,9 @@ FdnReverberationNewAudioProcessorEditor::FdnReverberationNewAudioProcessorEditor
 {
     addAndMakeVisible(infoComp);
     addAndMakeVisible(mainComp);
+    infoComp.setMeterFeed(&processor.getMeterFeed());
     setSize (1000, 600);
+    setWantsKeyboardFocus(true);
 }
 
 FdnReverberationNewAudioProcessorEditor::~FdnReverberationNewAudioProcessorEditor()
@@ -478,6 +692,7 @@ FdnReverberationNewAudioProcessorEditor::~FdnReverberationNewAudioProcessorEdito
 
 void FdnReverberationNewAudioProcessorEditor::paint (Graphics& g)
 {
+    FDN_TRACE_SCOPE("Editor::paint");
     g.fillAll(Colours::darkgrey);
     getLookAndFeel().setColour(Slider::thumbColourId, Colours::white);
     getLookAndFeel().setColour(Slider::trackColourId, Colours::lightgrey);
@@ -485,6 +700,21 @@ void FdnReverberationNewAudioProcessorEditor::paint (Graphics& g)
     getLookAndFeel().setColour(Label::textColourId, Colours::whitesmoke);
 }
 
+bool FdnReverberationNewAudioProcessorEditor::keyPressed (const KeyPress& key)
+{
+   #if FDN_ENABLE_TRACE
+    // Cmd/Ctrl + Shift + T dumps the recorded timeline, open it in chrome://tracing or ui.perfetto.dev
+    if (key == KeyPress('t', ModifierKeys::commandModifier | ModifierKeys::shiftModifier, 0))
+    {
+        auto traceFile = File::getSpecialLocation(File::userDocumentsDirectory).getChildFile("FdnReverberation.trace.json");
+        auto exported = TraceRecorder::exportChromeTrace(traceFile);
+        infoComp.showInfo(exported ? "Trace saved to " + traceFile.getFullPathName() : "Cannot save the trace!");
+        return true;
+    }
+   #endif
+    return false;
+}
+
 void FdnReverberationNewAudioProcessorEditor::resized()
 {
     mainComp.setBounds(0, 0, getWidth()*3/4, getHeight());
@@ -4,6 +4,10 @@
 #include "PluginProcessor.h"
 #include "Reverberator.h"
 #include "CustomComponents.h"
+#include "Trace.h"
+#include "MeterFeed.h"
+#include "IrCache.h"
+#include "IrAnalyser.h"
 #include "vector"
 #include "array"
 
@@ -40,28 +44,62 @@ public:
 
 
 //==============================================================================
-class InfoComponent : public Component
+class InfoComponent : public Component, private Timer
 {
 public:
     InfoComponent();
+    ~InfoComponent();
     
     void paint (Graphics&) override;
     void resized() override;
     
     void showInfo (const String& str);
-    void showIR (Reverberator::FdnDimension dimension, const std::vector<int>& delays);
+    void showIR (Reverberator::FdnDimension dimension, const std::vector<int>& delays, double sampleRate, float decayTimeSeconds, float gain);
+    void setMeterFeed (MeterFeed* feed);
     
 private:
-    float* setPulse ();
     std::pair<float, float> findDataBoundaries ();
     void drawData (Graphics&);
+    void drawMeters (Graphics&);
+    void timerCallback() override;
+    void updateSpectrum ();
+    Rectangle<int> getMetersBounds () const;
+    void updateAnalysis ();
+    void drawAnalysis (Graphics&);
+    
+    class AnalysisJob;
     
     Label infoLabel;
     bool toShowIR = false;
     std::array<float, 44100> data;
+    SharedResourcePointer<IrCache> irCache;
     
     const int SamplesQuantity;
     
+    MeterFeed* meterFeed = nullptr;
+    MeterFeed::Levels levels {};
+    
+    static const int FftOrder = 10;
+    static const int FftSize = 1 << FftOrder;
+    dsp::FFT fft;
+    dsp::WindowingFunction<float> window;
+    std::array<float, FftSize> wetSamples;
+    std::array<float, 2 * FftSize> fftData;
+    std::array<float, FftSize / 2> spectrum; // dB
+    int wetSamplesQuantity = 0;
+    
+    // the IR lookup and analysis run on their own thread, the timer picks up the IR and the latest results
+    ThreadPool analysisPool { 1 };
+    CriticalSection analysisLock;
+    IrCache::ImpulseResponse pendingImpulseResponse; // guarded by analysisLock
+    std::unique_ptr<IrAnalyser::Results> pendingAnalysis; // guarded by analysisLock
+    IrAnalyser::Results analysis;
+    bool hasAnalysis = false;
+    
+    const int MetersHeight = 120;
+    const double AnalysisSeconds = 3.0;
+    const float LevelsDecay = 0.9f; // per timer tick, the bars fall smoothly instead of jumping
+    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (InfoComponent)
 };
 
@@ -138,6 +176,11 @@ private:
     CustomTextButton saveButton;
     CustomTextButton showIrButton;
     CustomSlider drywetSlider;
+    CustomSlider decaySlider;
+    
+    // attachments have to be destroyed before the sliders they are attached to
+    std::unique_ptr<AudioProcessorValueTreeState::SliderAttachment> drywetAttachment;
+    std::unique_ptr<AudioProcessorValueTreeState::SliderAttachment> decayAttachment;
 };
 
 //==============================================================================
@@ -179,6 +222,7 @@ public:
 
     void paint (Graphics&) override;
     void resized() override;
+    bool keyPressed (const KeyPress& key) override;
 
 private:
     FdnReverberationNewAudioProcessor& processor;
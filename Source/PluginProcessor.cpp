@@ -14,13 +14,65 @@ FdnReverberationNewAudioProcessor::FdnReverberationNewAudioProcessor(Reverberato
                        ),
 #endif
     dimension(dim),
-    powers(pow)
+    powers(pow),
+    parameters(*this, nullptr, Identifier("FdnReverberation"), createParameterLayout())
 {
     channelsNum = getTotalNumInputChannels();
+    dryWetParameter = dynamic_cast<AudioParameterFloat*>(parameters.getParameter("drywet"));
+    decayParameter = dynamic_cast<AudioParameterFloat*>(parameters.getParameter("decay"));
+    decayTimeParameter = dynamic_cast<AudioParameterFloat*>(parameters.getParameter("decaytime"));
+    governorParameter = dynamic_cast<AudioParameterBool*>(parameters.getParameter("governor"));
+    budgetParameter = dynamic_cast<AudioParameterFloat*>(parameters.getParameter("cpubudget"));
+    modulationParameter = dynamic_cast<AudioParameterFloat*>(parameters.getParameter("modulation"));
+    diffusionParameter = dynamic_cast<AudioParameterFloat*>(parameters.getParameter("diffusion"));
+    earlyParameter = dynamic_cast<AudioParameterFloat*>(parameters.getParameter("early"));
+    roomSizeParameter = dynamic_cast<AudioParameterFloat*>(parameters.getParameter("roomsize"));
+    multibandParameter = dynamic_cast<AudioParameterBool*>(parameters.getParameter("multiband"));
+    crossoverParameter = dynamic_cast<AudioParameterFloat*>(parameters.getParameter("crossover"));
+    lowDecayParameter = dynamic_cast<AudioParameterFloat*>(parameters.getParameter("lowdecay"));
+    lowDimensionParameter = dynamic_cast<AudioParameterChoice*>(parameters.getParameter("lowdimension"));
+    pipelineParameter = dynamic_cast<AudioParameterBool*>(parameters.getParameter("pipelined"));
+    decorrelationParameter = dynamic_cast<AudioParameterBool*>(parameters.getParameter("decorrelation"));
+    engineParameter = dynamic_cast<AudioParameterChoice*>(parameters.getParameter("engine"));
+    jassert(dryWetParameter != nullptr && decayParameter != nullptr && decayTimeParameter != nullptr && governorParameter != nullptr && budgetParameter != nullptr
+            && modulationParameter != nullptr && diffusionParameter != nullptr && earlyParameter != nullptr && roomSizeParameter != nullptr
+            && multibandParameter != nullptr && crossoverParameter != nullptr && lowDecayParameter != nullptr && lowDimensionParameter != nullptr
+            && pipelineParameter != nullptr
+            && decorrelationParameter != nullptr && engineParameter != nullptr);
 }
 
 FdnReverberationNewAudioProcessor::~FdnReverberationNewAudioProcessor()
 {
+    cancelPendingUpdate();
+    pipeline.stop(); // the helper thread renders into the members
+}
+
+AudioProcessorValueTreeState::ParameterLayout FdnReverberationNewAudioProcessor::createParameterLayout ()
+{
+    std::vector<std::unique_ptr<RangedAudioParameter>> params;
+    params.push_back(std::make_unique<AudioParameterFloat>("drywet", "Dry/Wet", NormalisableRange<float>(0.0f, 100.0f, 1.0f), 50.0f));
+    params.push_back(std::make_unique<AudioParameterFloat>("decay", "Decay Gain", NormalisableRange<float>(0.8f, 1.0f, 0.001f), 1.0f));
+    // RT60 of every network whatever its delays, the decay gain shortens it further
+    params.push_back(std::make_unique<AudioParameterFloat>("decaytime", "Decay Time", NormalisableRange<float>(0.1f, 20.0f, 0.01f, 0.4f), 2.0f));
+    params.push_back(std::make_unique<AudioParameterFloat>("modulation", "Modulation", NormalisableRange<float>(0.0f, 100.0f, 1.0f), 0.0f));
+    params.push_back(std::make_unique<AudioParameterFloat>("diffusion", "Input Diffusion", NormalisableRange<float>(0.0f, 100.0f, 1.0f), 0.0f));
+    params.push_back(std::make_unique<AudioParameterFloat>("early", "Early Reflections", NormalisableRange<float>(0.0f, 100.0f, 1.0f), 0.0f));
+    params.push_back(std::make_unique<AudioParameterFloat>("roomsize", "Room Size", NormalisableRange<float>(3.0f, 30.0f, 0.1f), 10.0f));
+    // the multiband mode runs the low band through a separate decimated network with its own decay
+    params.push_back(std::make_unique<AudioParameterBool>("multiband", "Multiband", false));
+    params.push_back(std::make_unique<AudioParameterFloat>("crossover", "Crossover", NormalisableRange<float>(100.0f, 1000.0f, 1.0f), 300.0f));
+    params.push_back(std::make_unique<AudioParameterFloat>("lowdecay", "Low Decay Gain", NormalisableRange<float>(0.8f, 1.0f, 0.001f), 1.0f));
+    params.push_back(std::make_unique<AudioParameterChoice>("lowdimension", "Low Band Lines", StringArray { "2", "4", "8" }, 1));
+    params.push_back(std::make_unique<AudioParameterBool>("decorrelation", "Stereo Decorrelation", false));
+    // the governor trades the network size for CPU time when processBlock gets close to the block deadline,
+    // the smaller networks are built when it is switched on and freed when it is switched off
+    params.push_back(std::make_unique<AudioParameterBool>("governor", "Quality Governor", false));
+    params.push_back(std::make_unique<AudioParameterFloat>("cpubudget", "CPU Budget", NormalisableRange<float>(5.0f, 100.0f, 1.0f), 50.0f));
+    // the wet signal is rendered on a helper thread one block late, the plugin reports a block of latency
+    params.push_back(std::make_unique<AudioParameterBool>("pipelined", "Pipelined Rendering", false));
+    // the implementation of the networks, see EngineRegistry
+    params.push_back(std::make_unique<AudioParameterChoice>("engine", "Engine", EngineRegistry::GetNames(), 0));
+    return { params.begin(), params.end() };
 }
 
 //==============================================================================
@@ -58,7 +110,10 @@ bool FdnReverberationNewAudioProcessor::isMidiEffect() const
 
 double FdnReverberationNewAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    if (reverberators.empty() || getSampleRate() <= 0.0)
+        return 0.0;
+    auto tail = reverberators[jmin(activeTier, (int)reverberators.size() - 1)]->GetTailSamples();
+    return std::isfinite(tail) ? tail / getSampleRate() : std::numeric_limits<double>::infinity();
 }
 
 int FdnReverberationNewAudioProcessor::getNumPrograms()
@@ -88,26 +143,42 @@ void FdnReverberationNewAudioProcessor::changeProgramName (int index, const Stri
 //==============================================================================
 void FdnReverberationNewAudioProcessor::setDimension (Reverberator::FdnDimension dim)
 {
+    FDN_TRACE_SCOPE("setDimension");
     suspendProcessing (true);
+    pipeline.waitUntilDone();
     state = ProcessingState::pending;
-    for (auto i = 0; i < channelsNum; ++i)
-        reverberators[i].SetDimension(dim);
     dimension = dim;
+    if (blockLength > 0)
+        updateReverberators();
     checkProcessingState();
     suspendProcessing (false);
 }
 
 void FdnReverberationNewAudioProcessor::setDelayPowers (const std::vector<int>& pow)
 {
+    FDN_TRACE_SCOPE("setDelayPowers");
     suspendProcessing (true);
+    pipeline.waitUntilDone();
     state = ProcessingState::pending;
-    for (auto i = 0; i < channelsNum; ++i)
-        reverberators[i].GenerateDelayValues(pow);
     powers = pow;
+    if (blockLength > 0)
+        updateReverberators();
     checkProcessingState();
     suspendProcessing (false);
 }
 
+void FdnReverberationNewAudioProcessor::setLowBandPowers (const std::vector<int>& pow)
+{
+    FDN_TRACE_SCOPE("setLowBandPowers");
+    jassert(pow.size() == (size_t)LowBandNetwork::MaxDimension);
+    suspendProcessing (true);
+    pipeline.waitUntilDone();
+    lowBandPowers = pow;
+    if (blockLength > 0)
+        updateLowBandNetwork();
+    suspendProcessing (false);
+}
+
 void FdnReverberationNewAudioProcessor::setProcessingFlag (ProcessingFlag flag)
 {
     this->flag = flag;
@@ -123,11 +194,6 @@ void FdnReverberationNewAudioProcessor::checkProcessingState ()
         state = (powers.size() == (int)dimension) ? ProcessingState::running : ProcessingState::pending;
 }
 
-void FdnReverberationNewAudioProcessor::setDryWet (float drywet)
-{
-    this->drywet = drywet;
-}
-
 const Reverberator::FdnDimension FdnReverberationNewAudioProcessor::getDimension ()
 {
     return dimension;
@@ -138,20 +204,262 @@ const std::vector<int>& FdnReverberationNewAudioProcessor::getDelayPowers ()
     return powers;
 }
 
+const std::vector<int>& FdnReverberationNewAudioProcessor::getLowBandPowers ()
+{
+    return lowBandPowers;
+}
+
+AudioProcessorValueTreeState& FdnReverberationNewAudioProcessor::getParameters ()
+{
+    return parameters;
+}
+
+MeterFeed& FdnReverberationNewAudioProcessor::getMeterFeed ()
+{
+    return meterFeed;
+}
+
 //==============================================================================
 void FdnReverberationNewAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
+    FDN_TRACE_SCOPE("prepareToPlay"); // claims the trace buffer of the thread as well, some hosts prepare on the audio thread
+    pipeline.stop();
     blockLength = samplesPerBlock;
     channelsNum = getTotalNumInputChannels();
-    for (auto i = 0; i < channelsNum; ++i)
-        reverberators.emplace_back(Reverberator(dimension, powers));
+    
+    dryWetRamp.resize(blockLength);
+    silence.assign(blockLength, 0.0f);
+    wetBuffer.setSize(jlimit(1, BatchReverberator::MaxLanes, channelsNum), blockLength);
+    fadingWetBuffer.setSize(wetBuffer.getNumChannels(), blockLength);
+    reflectionsBuffer.setSize(wetBuffer.getNumChannels(), blockLength);
+    networkInputBuffer.setSize(wetBuffer.getNumChannels(), blockLength);
+    earlyReflections.Prepare(sampleRate, blockLength, wetBuffer.getNumChannels());
+    currentEarlyLevel = -1.0f;
+    currentRoomSize = -1.0f;
+    updateEarlyReflections();
+    diffuser.Prepare(sampleRate, wetBuffer.getNumChannels());
+    diffuser.SetAmount(diffusionParameter->get() / 100.0f);
+    lowBandBuffer.setSize(wetBuffer.getNumChannels(), blockLength);
+    lowBand.Prepare(sampleRate, blockLength, wetBuffer.getNumChannels());
+    multibandActive = false;
+    decorrelator.Prepare(sampleRate, blockLength, wetBuffer.getNumChannels());
+    decorrelator.SetActive(decorrelationParameter->get());
+    fadeInRamp.resize(blockLength);
+    fadeOutRamp.resize(blockLength);
+    fadeLength = jmax(1, (int)(TierFadeSeconds * sampleRate));
+    dryWetSmoothed.reset(sampleRate, SmoothingTimeSeconds);
+    dryWetSmoothed.setCurrentAndTargetValue(dryWetParameter->get() / 100.0f);
+    currentDryWet = dryWetParameter->get();
+    decaySmoothed.reset(sampleRate, SmoothingTimeSeconds);
+    decaySmoothed.setCurrentAndTargetValue(decayParameter->get());
+    lowDecaySmoothed.reset(sampleRate, SmoothingTimeSeconds);
+    lowDecaySmoothed.setCurrentAndTargetValue(lowDecayParameter->get());
+    meterFeed.prepare(sampleRate);
+    
+    prepareReverberators();
     checkProcessingState();
+    preparePipeline();
+}
+
+void FdnReverberationNewAudioProcessor::preparePipeline ()
+{
+    // the latency is a whole prepared block: the wet signal of a host block is rendered while the host
+    // processes the next one, the dry signal is delayed by the same ring
+    pipeline.stop();
+    pipelined = pipelineParameter->get();
+    setLatencySamples (pipelined ? blockLength : 0);
+    if (! pipelined)
+    {
+        pipelineInput.setSize(0, 0);
+        pipelineWet.setSize(0, 0);
+        return;
+    }
+    
+    auto ringLength = nextPowerOfTwo(2 * blockLength);
+    pipelineInput.setSize(wetBuffer.getNumChannels(), ringLength);
+    pipelineInput.clear();
+    pipelineWet.setSize(wetBuffer.getNumChannels(), ringLength);
+    pipelineWet.clear();
+    for (int channel = 0; channel < wetBuffer.getNumChannels(); ++channel)
+    {
+        // both threads use the raw pointers, the buffers themselves are not touched until the next prepare
+        pipelineInputData[channel] = pipelineInput.getWritePointer(channel);
+        pipelineWetData[channel] = pipelineWet.getWritePointer(channel);
+    }
+    pipelineMask = ringLength - 1;
+    pipelinePosition = 0;
+    pipeline.start([this] (int startSample, int numSamples) { renderPipelineJob(startSample, numSamples); });
+}
+
+void FdnReverberationNewAudioProcessor::handleAsyncUpdate ()
+{
+    // the pipelined mode, the engine or the low band lines have been switched, the latency can only be
+    // changed from here and the networks are not created on the audio thread;
+    // the governor has been switched on or off, its tiers are built or freed here for the same reason
+    suspendProcessing (true);
+    if (blockLength > 0 && (pipelineParameter->get() != pipelined || engineParameter->getIndex() != currentEngine
+                            || lowDimensionParameter->getIndex() != currentLowDimension))
+    {
+        pipeline.stop();
+        if (engineParameter->getIndex() != currentEngine)
+            createReverberators();
+        if (lowDimensionParameter->getIndex() != currentLowDimension)
+            updateLowBandNetwork();
+        preparePipeline();
+    }
+    else
+        pipeline.waitUntilDone(); // the tiers only, the running pipeline job is the last user of the networks
+    
+    if (blockLength > 0)
+        updateQualityTiers();
+    suspendProcessing (false);
+}
+
+void FdnReverberationNewAudioProcessor::createReverberators ()
+{
+    // the networks are created once the powers match the dimension (see checkProcessingState() )
+    reverberators.clear();
+    activeTier = 0;
+    fadingTier = -1;
+    currentModulation = -1.0f;
+    currentDecayTime = -1.0f;
+    currentEngine = engineParameter->getIndex();
+    if (powers.size() != (size_t)dimension)
+        return;
+    
+    auto numLanes = jlimit(1, BatchReverberator::MaxLanes, channelsNum);
+    for (auto tier = 0; tier < getNumRequiredTiers(); ++tier)
+    {
+        reverberators.push_back(EngineRegistry::Create(currentEngine, getTierDimension(tier), getTierPowers(tier), numLanes));
+        reverberators.back()->Prepare(getSampleRate(), blockLength);
+    }
+    updateLowBandNetwork();
+    governor.prepare(getSampleRate(), (int)reverberators.size());
+}
+
+void FdnReverberationNewAudioProcessor::prepareReverberators ()
+{
+    // a host prepares again on every transport or device change, the networks of the same engine,
+    // channels and delays are kept with their memory and only prepared again (cleared)
+    auto numLanes = jlimit(1, BatchReverberator::MaxLanes, channelsNum);
+    if (powers.size() != (size_t)dimension || reverberators.size() != (size_t)getNumRequiredTiers()
+        || engineParameter->getIndex() != currentEngine || reverberators[0]->GetNumLanes() != numLanes)
+    {
+        createReverberators();
+        return;
+    }
+    
+    for (auto &it : reverberators)
+        it->Prepare(getSampleRate(), blockLength);
+    activeTier = 0;
+    fadingTier = -1;
+    currentModulation = -1.0f; // the rate dependent settings follow the new sample rate
+    currentDecayTime = -1.0f;
+    updateLowBandNetwork();
+    governor.prepare(getSampleRate(), (int)reverberators.size());
+}
+
+void FdnReverberationNewAudioProcessor::updateReverberators ()
+{
+    // the networks are reconfigured in place while the set of tiers stays the same, so new delays
+    // cost no allocations and clear only the memory they read (see BatchReverberator::ClearReadRegions() )
+    if (powers.size() != (size_t)dimension)
+        return; // the processing is pending until the powers match, the old networks are kept until then
+    if (reverberators.size() != (size_t)getNumRequiredTiers())
+    {
+        createReverberators();
+        return;
+    }
+    
+    for (auto tier = 0; tier < (int)reverberators.size(); ++tier)
+    {
+        reverberators[tier]->SetDimension(getTierDimension(tier));
+        reverberators[tier]->GenerateDelayValues(getTierPowers(tier));
+    }
+    updateLowBandNetwork();
+    fadingTier = -1;
+}
+
+void FdnReverberationNewAudioProcessor::updateLowBandNetwork ()
+{
+    // a small network of its own, independent of the full one: 2, 4 or 8 lines on primes the full one does not use
+    currentLowDimension = lowDimensionParameter->getIndex();
+    auto N = 2 << currentLowDimension;
+    lowBand.SetNetwork((Reverberator::FdnDimension)N, std::vector<int> (lowBandPowers.begin(), lowBandPowers.begin() + N));
+}
+
+void FdnReverberationNewAudioProcessor::updateQualityTiers ()
+{
+    // message thread, with the processing suspended: the lower tiers are appended to the full network,
+    // or freed once the full network is back on its own (the switch back fades like any other)
+    if (reverberators.empty() || ! qualityTiersOutOfDate())
+        return;
+    
+    if (governorParameter->get())
+    {
+        auto numLanes = reverberators[0]->GetNumLanes();
+        for (auto tier = (int)reverberators.size(); tier < getNumQualityTiers(); ++tier)
+        {
+            reverberators.push_back(EngineRegistry::Create(currentEngine, getTierDimension(tier), getTierPowers(tier), numLanes));
+            reverberators.back()->Prepare(getSampleRate(), blockLength);
+        }
+        currentDecayTime = -1.0f; // the new tiers get the RT60 with the next block
+    }
+    else
+        reverberators.resize(1);
+    governor.prepare(getSampleRate(), (int)reverberators.size());
+}
+
+bool FdnReverberationNewAudioProcessor::qualityTiersOutOfDate () const
+{
+    if (governorParameter->get())
+        return reverberators.size() < (size_t)getNumQualityTiers();
+    return reverberators.size() > 1 && activeTier == 0 && fadingTier < 0;
+}
+
+int FdnReverberationNewAudioProcessor::getNumRequiredTiers () const
+{
+    // only the full network while the governor is off, it would not use the others
+    return governorParameter->get() ? getNumQualityTiers() : 1;
+}
+
+int FdnReverberationNewAudioProcessor::getNumQualityTiers () const
+{
+    auto numTiers = 0;
+    for (auto N = (int)dimension; N >= 2 && numTiers < MaxQualityTiers; N /= 2)
+        ++numTiers;
+    return numTiers;
+}
+
+Reverberator::FdnDimension FdnReverberationNewAudioProcessor::getTierDimension (int tier) const
+{
+    return (Reverberator::FdnDimension)((int)dimension >> tier);
+}
+
+std::vector<int> FdnReverberationNewAudioProcessor::getTierPowers (int tier) const
+{
+    // a smaller tier keeps the first lines of the full network
+    return std::vector<int> (powers.begin(), powers.begin() + (int)getTierDimension(tier));
 }
 
 void FdnReverberationNewAudioProcessor::releaseResources()
 {
-    // When playback stops, you can use this as an opportunity to free up any
-    // spare memory, etc.
+    // the delay memory goes back to the system, the next prepareToPlay() allocates it again;
+    // with blockLength 0 the setters and the async update do not create networks until then
+    pipeline.stop();
+    blockLength = 0;
+    pipelined = false; // the rings are gone as well
+    reverberators.clear();
+    lowBand.Release();
+    earlyReflections.Release();
+    diffuser.Release();
+    decorrelator.Release();
+    for (auto* it : { &wetBuffer, &fadingWetBuffer, &reflectionsBuffer, &networkInputBuffer, &lowBandBuffer, &pipelineInput, &pipelineWet })
+        it->setSize(0, 0);
+    std::vector<float>().swap(dryWetRamp);
+    std::vector<float>().swap(silence);
+    std::vector<float>().swap(fadeInRamp);
+    std::vector<float>().swap(fadeOutRamp);
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -180,24 +488,444 @@ bool FdnReverberationNewAudioProcessor::isBusesLayoutSupported (const BusesLayou
 
 void FdnReverberationNewAudioProcessor::processBlock (AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
 {
+    FDN_TRACE_SCOPE("processBlock");
     checkProcessingState();
-    if (state == ProcessingState::pending)
+    if (state == ProcessingState::pending || reverberators.empty())
+    {
+        // the dry signal passes through, with the latency the host has been told about
+        if (pipelined)
+            delayDryPipelined (buffer);
         return;
+    }
+    
+    // the engine belongs to the helper thread while a pipelined job runs, the job of the previous
+    // block is collected before anything here touches it
+    if (pipelined)
+        waitForPipelineJob();
+    if (pipelineParameter->get() != pipelined || engineParameter->getIndex() != currentEngine
+        || lowDimensionParameter->getIndex() != currentLowDimension || qualityTiersOutOfDate())
+        triggerAsyncUpdate();
+    
+    auto startTicks = Time::getHighResolutionTicks();
+    
+    updateDryWet();
+    decaySmoothed.setTargetValue(decayParameter->get());
+    updateModulation();
+    updateDecayTime();
+    updateEarlyReflections();
+    diffuser.SetAmount(diffusionParameter->get() / 100.0f);
+    updateLowBand();
+    decorrelator.SetActive(decorrelationParameter->get());
     
     ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
+    auto numSamples = buffer.getNumSamples();
     
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-        buffer.clear(i, 0, buffer.getNumSamples());
+        buffer.clear(i, 0, numSamples);
+    
+    if (pipelined)
+    {
+        processPipelined (buffer, midiMessages);
+        return;
+    }
+    
+    // the block is split at the event positions, so every parameter change is applied exactly at its sample
+    int renderFrom = 0;
+    int eventPosition = 0;
+    MidiMessage event;
+    MidiBuffer::Iterator eventIterator (midiMessages);
+    while (eventIterator.getNextEvent (event, eventPosition))
+    {
+        eventPosition = jlimit (renderFrom, numSamples, eventPosition);
+        renderSubBlock (buffer, renderFrom, eventPosition - renderFrom);
+        handleParameterEvent (event);
+        renderFrom = eventPosition;
+    }
+    renderSubBlock (buffer, renderFrom, numSamples - renderFrom);
+    
+    updateQualityTier (Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - startTicks), numSamples);
+}
+
+void FdnReverberationNewAudioProcessor::processPipelined (AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
+{
+    // the input goes to the ring at pipelinePosition and is handed to the helper thread, the output is mixed
+    // from the dry and wet ring samples one prepared block earlier, rendered during the previous callbacks
+    auto numSamples = buffer.getNumSamples();
+    auto numLanes = wetBuffer.getNumChannels();
+    auto numChannels = jmin(getTotalNumInputChannels(), numLanes);
+    float* wetOutputs[BatchReverberator::MaxLanes] = {};
+    for (int channel = 0; channel < numLanes; ++channel)
+        wetOutputs[channel] = wetBuffer.getWritePointer(channel);
+    
+    int eventPosition = 0;
+    MidiMessage event;
+    MidiBuffer::Iterator eventIterator (midiMessages);
+    auto hasEvent = eventIterator.getNextEvent (event, eventPosition);
     
-    for (int channel = 0; channel < totalNumInputChannels; ++channel)
+    for (auto pieceStart = 0; pieceStart < numSamples; )
     {
-        auto* channelData = buffer.getWritePointer(channel);
-        if (reverberators.size() <= channel)
-            reverberators.emplace_back(Reverberator(dimension, powers));
-        reverberators[channel].Reverberate(channelData, blockLength, drywet);
+        // a block longer than announced is split, every next piece waits for the previous one
+        auto pieceLength = jmin (numSamples - pieceStart, blockLength);
+        if (pieceStart > 0)
+            waitForPipelineJob();
+        
+        for (int channel = 0; channel < numLanes; ++channel)
+        {
+            auto* input = (channel < numChannels) ? buffer.getReadPointer(channel, pieceStart) : silence.data();
+            copyToRing (pipelineInputData[channel], pipelinePosition, input, pieceLength);
+        }
+        pipeline.submit(pipelinePosition, pieceLength);
+        
+        auto readPosition = (pipelinePosition - blockLength) & pipelineMask;
+        for (int channel = 0; channel < numLanes; ++channel)
+        {
+            if (channel < numChannels)
+                copyFromRing (pipelineInputData[channel], readPosition, buffer.getWritePointer(channel, pieceStart), pieceLength);
+            copyFromRing (pipelineWetData[channel], readPosition, wetOutputs[channel], pieceLength);
+        }
+        
+        // the dry/wet mix is split at the event positions like in the direct mode
+        auto mixFrom = pieceStart;
+        auto pieceEnd = pieceStart + pieceLength;
+        while (hasEvent && eventPosition < pieceEnd)
+        {
+            auto position = jlimit (mixFrom, pieceEnd, eventPosition);
+            float* mixOutputs[BatchReverberator::MaxLanes] = {};
+            for (int channel = 0; channel < numLanes; ++channel)
+                mixOutputs[channel] = wetOutputs[channel] + (mixFrom - pieceStart);
+            mixDryWet (buffer, mixFrom, mixOutputs, numChannels, position - mixFrom);
+            handleParameterEvent (event);
+            mixFrom = position;
+            hasEvent = eventIterator.getNextEvent (event, eventPosition);
+        }
+        float* mixOutputs[BatchReverberator::MaxLanes] = {};
+        for (int channel = 0; channel < numLanes; ++channel)
+            mixOutputs[channel] = wetOutputs[channel] + (mixFrom - pieceStart);
+        mixDryWet (buffer, mixFrom, mixOutputs, numChannels, pieceEnd - mixFrom);
+        
+        pipelinePosition = (pipelinePosition + pieceLength) & pipelineMask;
+        pieceStart = pieceEnd;
     }
+    
+    for (; hasEvent; hasEvent = eventIterator.getNextEvent (event, eventPosition))
+        handleParameterEvent (event);
+}
+
+void FdnReverberationNewAudioProcessor::delayDryPipelined (AudioBuffer<float>& buffer)
+{
+    // the input goes through the ring like in processPipelined(), nothing is rendered for it:
+    // the wet ring is cleared instead, so the blocks after the pending state start from silence
+    pipeline.waitUntilDone();
+    auto numSamples = buffer.getNumSamples();
+    auto numLanes = wetBuffer.getNumChannels();
+    auto numChannels = jmin(getTotalNumInputChannels(), numLanes);
+    for (auto pieceStart = 0; pieceStart < numSamples; )
+    {
+        auto pieceLength = jmin (numSamples - pieceStart, blockLength);
+        auto readPosition = (pipelinePosition - blockLength) & pipelineMask;
+        for (int channel = 0; channel < numLanes; ++channel)
+        {
+            auto* input = (channel < numChannels) ? buffer.getReadPointer(channel, pieceStart) : silence.data();
+            copyToRing (pipelineInputData[channel], pipelinePosition, input, pieceLength);
+            copyToRing (pipelineWetData[channel], pipelinePosition, silence.data(), pieceLength);
+            if (channel < numChannels)
+                copyFromRing (pipelineInputData[channel], readPosition, buffer.getWritePointer(channel, pieceStart), pieceLength);
+        }
+        pipelinePosition = (pipelinePosition + pieceLength) & pipelineMask;
+        pieceStart += pieceLength;
+    }
+}
+
+void FdnReverberationNewAudioProcessor::waitForPipelineJob ()
+{
+    // the governor measures the helper thread, its deadline is a block as well
+    pipeline.waitUntilDone();
+    if (pipeline.getLastJobLength() > 0)
+        updateQualityTier (pipeline.getLastJobSeconds(), pipeline.getLastJobLength());
+}
+
+void FdnReverberationNewAudioProcessor::renderPipelineJob (int startSample, int numSamples)
+{
+    // helper thread, the ring range is split where it wraps around
+    FDN_TRACE_SCOPE("renderPipelineJob");
+    ScopedNoDenormals noDenormals;
+    const float* inputs[BatchReverberator::MaxLanes] = {};
+    float* wetOutputs[BatchReverberator::MaxLanes] = {};
+    while (numSamples > 0)
+    {
+        auto length = jmin (numSamples, pipelineMask + 1 - startSample);
+        for (int channel = 0; channel < wetBuffer.getNumChannels(); ++channel)
+        {
+            inputs[channel] = pipelineInputData[channel] + startSample;
+            wetOutputs[channel] = pipelineWetData[channel] + startSample;
+        }
+        renderWet(inputs, wetOutputs, length);
+        startSample = (startSample + length) & pipelineMask;
+        numSamples -= length;
+    }
+}
+
+void FdnReverberationNewAudioProcessor::copyToRing (float* ring, int position, const float* source, int numSamples) const
+{
+    auto firstPart = jmin (numSamples, pipelineMask + 1 - position);
+    FloatVectorOperations::copy (ring + position, source, firstPart);
+    FloatVectorOperations::copy (ring, source + firstPart, numSamples - firstPart);
+}
+
+void FdnReverberationNewAudioProcessor::copyFromRing (const float* ring, int position, float* destination, int numSamples) const
+{
+    auto firstPart = jmin (numSamples, pipelineMask + 1 - position);
+    FloatVectorOperations::copy (destination, ring + position, firstPart);
+    FloatVectorOperations::copy (destination + firstPart, ring, numSamples - firstPart);
+}
+
+void FdnReverberationNewAudioProcessor::updateModulation ()
+{
+    // only the full network is modulated, the lower quality tiers save the rotations as well
+    auto modulation = modulationParameter->get();
+    if (modulation == currentModulation)
+        return;
+    
+    reverberators[0]->SetModulation(MaxModulationDepth * modulation / 100.0f, ModulationRateHz, getSampleRate());
+    currentModulation = modulation;
+}
+
+void FdnReverberationNewAudioProcessor::updateDecayTime ()
+{
+    // every tier gets the same RT60 from its own delays, so a tier switch keeps the decay
+    auto decayTime = decayTimeParameter->get();
+    if (decayTime == currentDecayTime)
+        return;
+    
+    for (auto &it : reverberators)
+        it->SetDecayTime(decayTime, getSampleRate());
+    lowBand.SetDecayTime(decayTime);
+    currentDecayTime = decayTime;
+}
+
+void FdnReverberationNewAudioProcessor::updateEarlyReflections ()
+{
+    // the taps are recalculated only when the room changes, the level is a gain on top of them
+    auto level = earlyParameter->get() / 100.0f;
+    auto roomSize = roomSizeParameter->get();
+    if (roomSize != currentRoomSize)
+    {
+        earlyReflections.SetRoom(roomSize);
+        currentRoomSize = roomSize;
+    }
+    if (level != currentEarlyLevel)
+    {
+        earlyReflections.SetLevel(MaxEarlyReflectionsLevel * level);
+        currentEarlyLevel = level;
+    }
+}
+
+void FdnReverberationNewAudioProcessor::updateLowBand ()
+{
+    auto enabled = multibandParameter->get();
+    if (enabled && ! multibandActive)
+        lowBand.Reset(); // the low network is not processed while the mode is off
+    multibandActive = enabled;
+    lowBand.SetCrossover(crossoverParameter->get());
+    lowDecaySmoothed.setTargetValue(lowDecayParameter->get());
+}
+
+void FdnReverberationNewAudioProcessor::updateQualityTier (double elapsedSeconds, int numSamples)
+{
+    if (! governorParameter->get())
+    {
+        if (governor.getTier() != 0)
+            governor.reset();
+    }
+    else if (fadingTier >= 0)
+    {
+        // nothing is decided in the middle of a switch, both networks are running
+        governor.hold();
+        return;
+    }
+    else
+    {
+        governor.setBudget(budgetParameter->get() / 100.0f);
+        governor.update(elapsedSeconds, numSamples);
+    }
+    
+    auto tier = jmin(governor.getTier(), (int)reverberators.size() - 1);
+    if (tier != activeTier && fadingTier < 0)
+        switchQualityTier(tier);
+}
+
+void FdnReverberationNewAudioProcessor::switchQualityTier (int tier)
+{
+    // the new network starts from silence and is faded in while the old tail is faded out, so a switch
+    // costs the tail built up so far: after TierFadeSeconds only the input of the fade is left in the network,
+    // a dip in the tail that is still better than a dropout. Keeping the next tier running in advance would
+    // avoid it, but it would add its load exactly when the instance is close to its budget.
+    reverberators[tier]->Reset();
+    fadingTier = activeTier;
+    activeTier = tier;
+    fadeSamplesRemaining = fadeLength;
+}
+
+void FdnReverberationNewAudioProcessor::crossfadeQualityTiers (const float* const* inputs, float* const* wetOutputs, int numSamples, float gain)
+{
+    auto* fading = reverberators[fadingTier].get();
+    float* fadingOutputs[BatchReverberator::MaxLanes] = {};
+    for (int channel = 0; channel < fading->GetNumLanes(); ++channel)
+        fadingOutputs[channel] = fadingWetBuffer.getWritePointer(channel);
+    fading->SetGain(gain);
+    fading->Reverberate(inputs, fadingOutputs, (unsigned)numSamples);
+    
+    // equal power, the tails of the two networks are not correlated
+    for (auto n = 0; n < numSamples; ++n)
+    {
+        auto position = 1.0f - (float)jmax(0, fadeSamplesRemaining - n - 1) / (float)fadeLength;
+        fadeInRamp[n] = std::sin(position * MathConstants<float>::halfPi);
+        fadeOutRamp[n] = std::cos(position * MathConstants<float>::halfPi);
+    }
+    for (int channel = 0; channel < fading->GetNumLanes(); ++channel)
+    {
+        FloatVectorOperations::multiply(wetOutputs[channel], fadeInRamp.data(), numSamples);
+        FloatVectorOperations::addWithMultiply(wetOutputs[channel], fadingOutputs[channel], fadeOutRamp.data(), numSamples);
+    }
+    
+    fadeSamplesRemaining -= numSamples;
+    if (fadeSamplesRemaining <= 0)
+        fadingTier = -1;
+}
+
+void FdnReverberationNewAudioProcessor::renderSubBlock (AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    // hosts are allowed to send blocks larger than announced, so the range is chunked by the prepared block length
+    auto numLanes = reverberators[activeTier]->GetNumLanes();
+    auto numChannels = jmin(getTotalNumInputChannels(), numLanes, wetBuffer.getNumChannels());
+    const float* inputs[BatchReverberator::MaxLanes] = {};
+    float* wetOutputs[BatchReverberator::MaxLanes] = {};
+    
+    while (numSamples > 0)
+    {
+        auto chunkLength = jmin (numSamples, blockLength);
+        for (int channel = 0; channel < numLanes; ++channel)
+        {
+            // the lanes without a channel (the host sent less channels than prepared) run on silence
+            inputs[channel] = (channel < numChannels) ? buffer.getReadPointer(channel, startSample) : silence.data();
+            wetOutputs[channel] = wetBuffer.getWritePointer(channel);
+        }
+        
+        renderWet(inputs, wetOutputs, chunkLength);
+        mixDryWet(buffer, startSample, wetOutputs, numChannels, chunkLength);
+        startSample += chunkLength;
+        numSamples -= chunkLength;
+    }
+}
+
+void FdnReverberationNewAudioProcessor::renderWet (const float* const* channelInputs, float* const* wetOutputs, int chunkLength)
+{
+    // everything the engine does for one chunk of at most blockLength samples, the wet signal only
+    auto* reverberator = reverberators[activeTier].get();
+    auto numLanes = reverberator->GetNumLanes();
+    const float* inputs[BatchReverberator::MaxLanes] = {};
+    std::copy(channelInputs, channelInputs + numLanes, inputs);
+    
+    auto gain = decaySmoothed.skip(chunkLength);
+    reverberator->SetGain(gain);
+    
+    // the network is fed with the input and its early reflections, the reflections go to the output as well
+    float* reflections[BatchReverberator::MaxLanes] = {};
+    float* networkInputs[BatchReverberator::MaxLanes] = {};
+    for (int channel = 0; channel < numLanes; ++channel)
+    {
+        reflections[channel] = reflectionsBuffer.getWritePointer(channel);
+        networkInputs[channel] = networkInputBuffer.getWritePointer(channel);
+    }
+    // the level may fade out inside the block, the reflections of the block go to the output all the same
+    auto reflectionsActive = earlyReflections.IsActive();
+    if (reflectionsActive)
+    {
+        earlyReflections.Process(inputs, reflections, (unsigned)chunkLength);
+        for (int channel = 0; channel < numLanes; ++channel)
+            FloatVectorOperations::add(networkInputs[channel], inputs[channel], reflections[channel], chunkLength);
+        std::copy(networkInputs, networkInputs + numLanes, inputs);
+    }
+    if (diffuser.IsActive())
+    {
+        diffuser.Process(inputs, networkInputs, (unsigned)chunkLength);
+        std::copy(networkInputs, networkInputs + numLanes, inputs);
+    }
+    
+    // in the multiband mode the main network gets the high band only
+    float* lowBandOutputs[BatchReverberator::MaxLanes] = {};
+    auto lowGain = lowDecaySmoothed.skip(chunkLength);
+    if (multibandActive)
+    {
+        for (int channel = 0; channel < numLanes; ++channel)
+            lowBandOutputs[channel] = lowBandBuffer.getWritePointer(channel);
+        // the same gain per pass of a network Decimation times slower decays that much slower
+        lowBand.SetGain(std::pow(lowGain, (float)LowBandNetwork::Decimation));
+        lowBand.Process(inputs, networkInputs, lowBandOutputs, (unsigned)chunkLength);
+        std::copy(networkInputs, networkInputs + numLanes, inputs);
+    }
+    
+    reverberator->Reverberate(inputs, wetOutputs, (unsigned)chunkLength);
+    if (fadingTier >= 0)
+        crossfadeQualityTiers(inputs, wetOutputs, chunkLength, gain);
+    if (multibandActive)
+        for (int channel = 0; channel < numLanes; ++channel)
+            FloatVectorOperations::add(wetOutputs[channel], lowBandOutputs[channel], chunkLength);
+    if (reflectionsActive)
+        for (int channel = 0; channel < numLanes; ++channel)
+            FloatVectorOperations::add(wetOutputs[channel], reflections[channel], chunkLength);
+    if (decorrelator.IsActive())
+        decorrelator.Process(wetOutputs, (unsigned)chunkLength);
+    meterFeed.pushWet(wetOutputs[0], chunkLength);
+}
+
+void FdnReverberationNewAudioProcessor::mixDryWet (AudioBuffer<float>& buffer, int startSample, float* const* wetOutputs, int numChannels, int numSamples)
+{
+    fillRamp(dryWetSmoothed, dryWetRamp.data(), numSamples);
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* channelData = buffer.getWritePointer(channel, startSample);
+        auto* wetData = wetOutputs[channel];
+        
+        // out = dry + drywet * (wet - dry)
+        FloatVectorOperations::subtract(wetData, channelData, numSamples);
+        FloatVectorOperations::multiply(wetData, dryWetRamp.data(), numSamples);
+        FloatVectorOperations::add(channelData, wetData, numSamples);
+    }
+    meterFeed.pushOutput(buffer, startSample, numSamples);
+}
+
+void FdnReverberationNewAudioProcessor::fillRamp (LinearSmoothedValue<float>& value, float* ramp, int numSamples)
+{
+    if (! value.isSmoothing())
+    {
+        FloatVectorOperations::fill(ramp, value.getTargetValue(), numSamples);
+        return;
+    }
+    
+    auto start = value.getCurrentValue();
+    auto step = (value.skip(numSamples) - start) / (float)numSamples;
+    for (auto n = 0; n < numSamples; ++n)
+        ramp[n] = start + step * (float)(n + 1);
+}
+
+void FdnReverberationNewAudioProcessor::handleParameterEvent (const MidiMessage& event)
+{
+    // CC 91 is the General MIDI "reverb depth" controller. It drives the smoother only, the host is not
+    // notified from the audio thread; the parameter takes over again at its next change (see updateDryWet() )
+    if (event.isControllerOfType (DryWetController))
+        dryWetSmoothed.setTargetValue((float)event.getControllerValue() / 127.0f);
+}
+
+void FdnReverberationNewAudioProcessor::updateDryWet ()
+{
+    auto dryWet = dryWetParameter->get();
+    if (dryWet == currentDryWet)
+        return;
+    currentDryWet = dryWet;
+    dryWetSmoothed.setTargetValue(dryWet / 100.0f);
 }
 
 //==============================================================================
@@ -214,15 +942,15 @@ AudioProcessorEditor* FdnReverberationNewAudioProcessor::createEditor()
 //==============================================================================
 void FdnReverberationNewAudioProcessor::getStateInformation (MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    std::unique_ptr<XmlElement> xml (parameters.copyState().createXml());
+    copyXmlToBinary (*xml, destData);
 }
 
 void FdnReverberationNewAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    std::unique_ptr<XmlElement> xml (getXmlFromBinary (data, sizeInBytes));
+    if (xml != nullptr && xml->hasTagName (parameters.state.getType()))
+        parameters.replaceState (ValueTree::fromXml (*xml));
 }
 
 //==============================================================================
@@ -2,11 +2,22 @@
 
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "Reverberator.h"
+#include "BatchReverberator.h"
+#include "ReverbEngine.h"
+#include "Trace.h"
+#include "MeterFeed.h"
+#include "CpuGovernor.h"
+#include "InputDiffuser.h"
+#include "EarlyReflections.h"
+#include "LowBandNetwork.h"
+#include "RenderPipeline.h"
+#include "VelvetDecorrelator.h"
 
 //==============================================================================
 /**
 */
-class FdnReverberationNewAudioProcessor  : public AudioProcessor
+class FdnReverberationNewAudioProcessor  : public AudioProcessor,
+                                           private AsyncUpdater
 {
 public:
     enum class ProcessingFlag { forbidden = false, allowed = true };
@@ -51,11 +62,14 @@ public:
     //==============================================================================
     void setDimension (Reverberator::FdnDimension dim);
     void setDelayPowers (const std::vector<int>& pow);
+    void setLowBandPowers (const std::vector<int>& pow); // LowBandNetwork::MaxDimension of them, the "lowdimension" first are used
     void setProcessingFlag (ProcessingFlag flag);
-    void setDryWet (float drywet);
     
     const Reverberator::FdnDimension getDimension ();
     const std::vector<int>& getDelayPowers ();
+    const std::vector<int>& getLowBandPowers ();
+    AudioProcessorValueTreeState& getParameters ();
+    MeterFeed& getMeterFeed ();
 
 private:
     //==============================================================================
@@ -64,16 +78,120 @@ private:
         pending, // waiting for a good conditions to process (see checkProcessingState() )
         running, // processing, but can be pended if the conditions become bad (see checkProcessingState() )
     };
+    static AudioProcessorValueTreeState::ParameterLayout createParameterLayout ();
+    static void fillRamp (LinearSmoothedValue<float>& value, float* ramp, int numSamples);
+    
     void checkProcessingState ();
+    void renderSubBlock (AudioBuffer<float>& buffer, int startSample, int numSamples);
+    void renderWet (const float* const* inputs, float* const* wetOutputs, int chunkLength);
+    void mixDryWet (AudioBuffer<float>& buffer, int startSample, float* const* wetOutputs, int numChannels, int numSamples);
+    void preparePipeline ();
+    void handleAsyncUpdate () override;
+    void processPipelined (AudioBuffer<float>& buffer, MidiBuffer& midiMessages);
+    void delayDryPipelined (AudioBuffer<float>& buffer);
+    void waitForPipelineJob ();
+    void renderPipelineJob (int startSample, int numSamples);
+    void copyToRing (float* ring, int position, const float* source, int numSamples) const;
+    void copyFromRing (const float* ring, int position, float* destination, int numSamples) const;
+    void handleParameterEvent (const MidiMessage& event);
+    void updateDryWet ();
+    void createReverberators ();
+    void prepareReverberators ();
+    void updateReverberators ();
+    void updateQualityTiers ();
+    bool qualityTiersOutOfDate () const;
+    int getNumRequiredTiers () const;
+    int getNumQualityTiers () const;
+    Reverberator::FdnDimension getTierDimension (int tier) const;
+    std::vector<int> getTierPowers (int tier) const;
+    void updateQualityTier (double elapsedSeconds, int numSamples);
+    void updateModulation ();
+    void updateDecayTime ();
+    void updateEarlyReflections ();
+    void updateLowBand ();
+    void updateLowBandNetwork ();
+    void switchQualityTier (int tier);
+    void crossfadeQualityTiers (const float* const* inputs, float* const* wetOutputs, int numSamples, float gain);
     
-    std::vector<Reverberator> reverberators; //according to the amount of channels
+    // one network per quality tier, [0] is the full one and every next tier has half the lines,
+    // the full one only while the governor is off (see updateQualityTiers() );
+    // one lane per channel, all of them created by the engine selected by the "engine" parameter
+    std::vector<std::unique_ptr<ReverbEngine>> reverberators;
+    int currentEngine = 0;
+    int activeTier = 0;
+    int fadingTier = -1; // the tier being faded out after a switch, -1 if there is none
+    int fadeSamplesRemaining = 0;
+    int fadeLength = 0;
+    std::vector<float> fadeInRamp;
+    std::vector<float> fadeOutRamp;
+    AudioBuffer<float> fadingWetBuffer;
+    CpuGovernor governor;
     ProcessingState state = ProcessingState::pending;
     ProcessingFlag flag = ProcessingFlag::allowed;
     Reverberator::FdnDimension dimension;
     std::vector<int> powers;
+    std::vector<int> lowBandPowers { 2, 1, 2, 1, 2, 1, 2, 1 }; // on primes of its own, see LowBandNetwork
     int channelsNum;
     int blockLength = 0;
-    float drywet = 0.5f;
+    
+    AudioProcessorValueTreeState parameters;
+    AudioParameterFloat* dryWetParameter = nullptr; // the parameters are owned by the tree, the audio thread reads them directly
+    AudioParameterFloat* decayParameter = nullptr;
+    AudioParameterFloat* decayTimeParameter = nullptr;
+    AudioParameterBool* governorParameter = nullptr;
+    AudioParameterFloat* budgetParameter = nullptr;
+    AudioParameterFloat* modulationParameter = nullptr;
+    AudioParameterFloat* diffusionParameter = nullptr;
+    AudioParameterFloat* earlyParameter = nullptr;
+    AudioParameterFloat* roomSizeParameter = nullptr;
+    AudioParameterBool* multibandParameter = nullptr;
+    AudioParameterFloat* crossoverParameter = nullptr;
+    AudioParameterFloat* lowDecayParameter = nullptr;
+    AudioParameterChoice* lowDimensionParameter = nullptr;
+    AudioParameterBool* pipelineParameter = nullptr;
+    AudioParameterBool* decorrelationParameter = nullptr;
+    AudioParameterChoice* engineParameter = nullptr;
+    float currentDryWet = -1.0f; // the parameter value the smoother was last set from
+    float currentEarlyLevel = -1.0f;
+    float currentRoomSize = -1.0f;
+    float currentModulation = -1.0f; // the value the full network runs with, -1 forces an update
+    float currentDecayTime = -1.0f;
+    int currentLowDimension = -1; // the index of the "lowdimension" choice the low network is built for
+    
+    LinearSmoothedValue<float> dryWetSmoothed;
+    LinearSmoothedValue<float> decaySmoothed;
+    LinearSmoothedValue<float> lowDecaySmoothed;
+    std::vector<float> dryWetRamp; // per-sample dry/wet values of the current chunk
+    std::vector<float> silence;
+    AudioBuffer<float> wetBuffer;
+    EarlyReflections earlyReflections; // shared by all the quality tiers
+    InputDiffuser diffuser;
+    AudioBuffer<float> reflectionsBuffer;
+    AudioBuffer<float> networkInputBuffer; // the input with the early reflections and the diffusion
+    LowBandNetwork lowBand; // the multiband mode only, the main network gets the high band then
+    AudioBuffer<float> lowBandBuffer;
+    bool multibandActive = false;
+    VelvetDecorrelator decorrelator; // the last stage of the wet signal
+    MeterFeed meterFeed;
+    
+    // the pipelined mode: the rings hold the input and the wet output of the helper thread, the audio thread
+    // writes the input at pipelinePosition and reads both one prepared block behind it
+    RenderPipeline pipeline;
+    bool pipelined = false; // follows the parameter at the next prepare or async update
+    AudioBuffer<float> pipelineInput;
+    AudioBuffer<float> pipelineWet;
+    float* pipelineInputData[BatchReverberator::MaxLanes] = {};
+    float* pipelineWetData[BatchReverberator::MaxLanes] = {};
+    int pipelineMask = 0;
+    int pipelinePosition = 0;
+    
+    const int DryWetController = 91;
+    const double SmoothingTimeSeconds = 0.05;
+    const double TierFadeSeconds = 0.25;
+    const float MaxModulationDepth = 0.5f; // radians of the feedback rotations
+    const float ModulationRateHz = 0.3f;
+    const float MaxEarlyReflectionsLevel = 0.3f; // the taps of a room add up to several times the direct sound
+    static const int MaxQualityTiers = 4; // 16, 8, 4 and 2 lines
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FdnReverberationNewAudioProcessor)
 };
@@ -0,0 +1,159 @@
+/*
+  ==============================================================================
+
+    RenderPipeline.cpp
+    Created: 25 Oct 2026 10:07:51am
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#include "RenderPipeline.h"
+#include "Trace.h"
+#include "thread"
+
+#if JUCE_MAC || JUCE_IOS
+ #include <dispatch/dispatch.h>
+#elif JUCE_WINDOWS
+ #include <windows.h>
+#else
+ #include <semaphore.h>
+ #include <cerrno>
+#endif
+
+// a counting semaphore of the OS: post() never takes a lock in user space
+class RenderPipeline::Semaphore
+{
+public:
+   #if JUCE_MAC || JUCE_IOS
+    Semaphore() : semaphore(dispatch_semaphore_create(0)) {}
+    ~Semaphore() { dispatch_release(semaphore); }
+    void post() { dispatch_semaphore_signal(semaphore); }
+    void wait() { dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER); }
+
+private:
+    dispatch_semaphore_t semaphore;
+   #elif JUCE_WINDOWS
+    Semaphore() : semaphore(CreateSemaphore(nullptr, 0, MAXLONG, nullptr)) {}
+    ~Semaphore() { CloseHandle(semaphore); }
+    void post() { ReleaseSemaphore(semaphore, 1, nullptr); }
+    void wait() { WaitForSingleObject(semaphore, INFINITE); }
+
+private:
+    HANDLE semaphore;
+   #else
+    Semaphore() { sem_init(&semaphore, 0, 0); }
+    ~Semaphore() { sem_destroy(&semaphore); }
+    void post() { sem_post(&semaphore); }
+    void wait() { while (sem_wait(&semaphore) != 0 && errno == EINTR) {} }
+
+private:
+    sem_t semaphore;
+   #endif
+
+    JUCE_DECLARE_NON_COPYABLE (Semaphore)
+};
+
+RenderPipeline::RenderPipeline() :
+        Thread("FDN render"),
+        jobReady(new Semaphore()),
+        jobDone(new Semaphore())
+{
+}
+
+RenderPipeline::~RenderPipeline()
+{
+    stop();
+}
+
+void RenderPipeline::start(RenderFunction function)
+{
+    stop();
+    render = std::move(function);
+    lastJobSeconds = 0.0;
+    lastJobLength = 0;
+    helperSleeping.store(false);
+    callerWaiting.store(false);
+    startThread(RealtimePriority);
+}
+
+void RenderPipeline::stop()
+{
+    if (! isThreadRunning())
+        return;
+
+    waitUntilDone();
+    signalThreadShouldExit();
+    jobReady->post(); // a post the helper thread does not sleep on only makes its loop look once more
+    stopThread(1000);
+}
+
+bool RenderPipeline::isRunning() const
+{
+    return isThreadRunning();
+}
+
+void RenderPipeline::submit(int startSample, int numSamples)
+{
+    jassert(! busy.load());
+    jobStart = startSample;
+    jobLength = numSamples;
+    busy.store(true);
+    if (helperSleeping.exchange(false))
+        jobReady->post();
+}
+
+void RenderPipeline::waitUntilDone()
+{
+    if (! busy.load(std::memory_order_acquire))
+        return;
+
+    // the job had a whole block of time, normally it ends within the spin
+    auto spinEnd = Time::getHighResolutionTicks() + Time::secondsToHighResolutionTicks(MaxSpinSeconds);
+    while (Time::getHighResolutionTicks() < spinEnd)
+    {
+        if (! busy.load(std::memory_order_acquire))
+            return;
+        std::this_thread::yield();
+    }
+
+    // the same handshake as in run(): if the flag is gone the helper thread has seen it and posts
+    callerWaiting.store(true);
+    if (busy.load() || ! callerWaiting.exchange(false))
+        jobDone->wait();
+}
+
+double RenderPipeline::getLastJobSeconds() const
+{
+    return lastJobSeconds;
+}
+
+int RenderPipeline::getLastJobLength() const
+{
+    return lastJobLength;
+}
+
+void RenderPipeline::run()
+{
+    FDN_TRACE_CLAIM_THREAD();
+    while (! threadShouldExit())
+    {
+        if (! busy.load())
+        {
+            // the sleep is announced before the last look at the job: a job submitted in between either
+            // finds the flag and posts, or is found here; if the flag is gone its post has to be taken
+            helperSleeping.store(true);
+            if ((! busy.load() && ! threadShouldExit()) || ! helperSleeping.exchange(false))
+                jobReady->wait();
+            continue;
+        }
+
+        auto startTicks = Time::getHighResolutionTicks();
+        render(jobStart, jobLength);
+        lastJobSeconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks);
+        lastJobLength = jobLength;
+        busy.store(false);
+        if (callerWaiting.exchange(false))
+            jobDone->post();
+    }
+}
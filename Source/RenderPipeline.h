@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    RenderPipeline.h
+    Created: 25 Oct 2026 10:07:51am
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "atomic"
+#include "functional"
+#include "memory"
+
+// Runs the render jobs of the audio thread on a helper thread, one job at a time: the audio thread submits
+// the job of a block and collects it at its next callback, so the two threads overlap by one block.
+// The hand-off is an atomic flag. A side that has nothing to do announces that it goes to sleep and sleeps
+// on a semaphore of the OS (a futex on Linux), the other side posts it only if the flag says so:
+// no mutex is taken on the audio thread, a post is one system call at most.
+class RenderPipeline : private Thread
+{
+public:
+    using RenderFunction = std::function<void (int startSample, int numSamples)>;
+
+    RenderPipeline();
+    ~RenderPipeline();
+
+    void start(RenderFunction function); // message thread, the helper thread gets the realtime priority
+    void stop(); // waits for the running job
+    bool isRunning() const;
+
+    // audio thread
+    void submit(int startSample, int numSamples);
+    // returns at once if there is no job, otherwise spins for MaxSpinSeconds at most and then sleeps until
+    // the job ends: the job cannot be abandoned, the network belongs to the helper thread until it returns
+    void waitUntilDone();
+    double getLastJobSeconds() const;
+    int getLastJobLength() const; // 0 before the first job
+
+private:
+    class Semaphore;
+
+    void run() override;
+
+    RenderFunction render;
+    std::unique_ptr<Semaphore> jobReady; // the helper thread sleeps on it
+    std::unique_ptr<Semaphore> jobDone; // the audio thread sleeps on it once the spin is over
+    std::atomic<bool> busy { false };
+    std::atomic<bool> helperSleeping { false };
+    std::atomic<bool> callerWaiting { false };
+
+    // written by the audio thread before busy is set
+    int jobStart = 0;
+    int jobLength = 0;
+    // written by the helper thread before busy is cleared
+    double lastJobSeconds = 0.0;
+    int lastJobLength = 0;
+
+    const int RealtimePriority = 10;
+    const double MaxSpinSeconds = 0.0001;
+};
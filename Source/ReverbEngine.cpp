@@ -0,0 +1,180 @@
+/*
+  ==============================================================================
+
+    ReverbEngine.cpp
+    Created: 27 Oct 2026 10:32:57am
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#include "ReverbEngine.h"
+#include "BatchReverberator.h"
+#include "limits"
+
+double ReverbEngine::CalculateTailSamples(const std::vector<int>& delays, const std::vector<float>& lineGains)
+{
+    auto tail = 0.0;
+    for (size_t i = 0; i < jmin(delays.size(), lineGains.size()); ++i)
+    {
+        auto passGain = (double)Reverberator::commonMatrixGain * lineGains[i];
+        if (passGain >= 1.0)
+            return std::numeric_limits<double>::infinity();
+        if (passGain > 0.0)
+            tail = jmax(tail, -3.0 * delays[i] / std::log10(passGain));
+    }
+    return tail;
+}
+
+// The original scalar network, one Reverberator per lane. The reference the other engines are compared with.
+// A Reverberator allocates its delay memory when it is built, so the lanes are built by Prepare();
+// until then the settings are only kept and applied to them there.
+class ScalarEngine : public ReverbEngine
+{
+public:
+    ScalarEngine(Reverberator::FdnDimension dim, const std::vector<int>& powers, int numLanes) :
+            numLanes(numLanes),
+            dimension(dim),
+            powers(powers),
+            delays(Reverberator::CalculateDelayValues(powers))
+    {
+    }
+
+    void Prepare(double sampleRate, int maxBlockSize) override
+    {
+        ignoreUnused(maxBlockSize); // a Reverberator takes blocks of any length
+        if (lanes.empty())
+            std::vector<Reverberator>((size_t)numLanes, Reverberator(dimension, powers)).swap(lanes);
+        decaySampleRate = sampleRate;
+        for (auto &it : lanes)
+        {
+            it.Reset();
+            it.SetGain(gain);
+            it.SetDecayTime(decayTime, decaySampleRate);
+            it.SetModulation(modulationDepth, modulationRate, modulationSampleRate);
+        }
+    }
+
+    void Reverberate(const float* const* inputs, float* const* wetOutputs, unsigned blockLength) override
+    {
+        jassert(! lanes.empty());
+        for (size_t k = 0; k < lanes.size(); ++k)
+            lanes[k].Reverberate(inputs[k], wetOutputs[k], blockLength);
+    }
+
+    void GenerateDelayValues(const std::vector<int>& powers) override
+    {
+        for (auto &it : lanes)
+            it.GenerateDelayValues(powers);
+        this->powers = powers;
+        delays = Reverberator::CalculateDelayValues(powers);
+    }
+
+    void SetDimension(Reverberator::FdnDimension dim) override
+    {
+        for (auto &it : lanes)
+            it.SetDimension(dim);
+        dimension = dim;
+    }
+
+    void Reset() override
+    {
+        for (auto &it : lanes)
+            it.Reset();
+    }
+
+    void SetGain(float gain) override
+    {
+        for (auto &it : lanes)
+            it.SetGain(gain);
+        this->gain = gain;
+    }
+
+    void SetDecayTime(float rt60Seconds, double sampleRate) override
+    {
+        for (auto &it : lanes)
+            it.SetDecayTime(rt60Seconds, sampleRate);
+        decayTime = rt60Seconds;
+        decaySampleRate = sampleRate;
+    }
+
+    void SetModulation(float depthRadians, float rateHz, double sampleRate) override
+    {
+        for (auto &it : lanes)
+            it.SetModulation(depthRadians, rateHz, sampleRate);
+        modulationDepth = depthRadians;
+        modulationRate = rateHz;
+        modulationSampleRate = sampleRate;
+    }
+
+    int GetNumLanes() const override
+    {
+        return numLanes;
+    }
+
+    double GetTailSamples() const override
+    {
+        auto lineGains = Reverberator::CalculateDecayGains(delays, decayTime, decaySampleRate);
+        for (auto &it : lineGains)
+            it *= gain;
+        return CalculateTailSamples(delays, lineGains);
+    }
+
+    size_t GetMemoryBytes() const override
+    {
+        size_t bytes = 0;
+        for (auto &it : lanes)
+            bytes += it.GetMemoryBytes();
+        return bytes;
+    }
+
+private:
+    const int numLanes;
+    std::vector<Reverberator> lanes; // empty until Prepare()
+    Reverberator::FdnDimension dimension;
+    std::vector<int> powers;
+    std::vector<int> delays;
+    float gain = 1.f;
+    float decayTime = 0.f;
+    double decaySampleRate = 44100.0;
+    float modulationDepth = 0.f;
+    float modulationRate = 0.f;
+    double modulationSampleRate = 44100.0;
+};
+
+std::vector<EngineRegistry::Entry>& EngineRegistry::GetEntries()
+{
+    // the first engine is the default one
+    static std::vector<Entry> entries =
+    {
+        { "Batch", [](Reverberator::FdnDimension dim, const std::vector<int>& powers, int numLanes)
+                   { return std::unique_ptr<ReverbEngine> (new BatchReverberator(dim, powers, numLanes)); } },
+        { "Scalar", [](Reverberator::FdnDimension dim, const std::vector<int>& powers, int numLanes)
+                    { return std::unique_ptr<ReverbEngine> (new ScalarEngine(dim, powers, numLanes)); } },
+    };
+    return entries;
+}
+
+void EngineRegistry::Register(const String& name, Factory create)
+{
+    GetEntries().push_back({ name, std::move(create) });
+}
+
+const std::vector<EngineRegistry::Entry>& EngineRegistry::GetEngines()
+{
+    return GetEntries();
+}
+
+StringArray EngineRegistry::GetNames()
+{
+    StringArray names;
+    for (auto &it : GetEntries())
+        names.add(it.name);
+    return names;
+}
+
+std::unique_ptr<ReverbEngine> EngineRegistry::Create(int index, Reverberator::FdnDimension dim, const std::vector<int>& powers, int numLanes)
+{
+    auto& entries = GetEntries();
+    return entries[(size_t)jlimit(0, (int)entries.size() - 1, index)].create(dim, powers, numLanes);
+}
@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+    ReverbEngine.h
+    Created: 27 Oct 2026 10:32:57am
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "functional"
+#include "memory"
+#include "vector"
+
+#include "Reverberator.h"
+
+// What the processor needs from a network that renders numLanes channels side by side.
+// The processor holds its networks through this interface only and creates them through the EngineRegistry,
+// so another implementation (a new kernel, a different topology) is a registration away from the plugin
+// and from the tools that iterate over the registry.
+class ReverbEngine
+{
+public:
+    virtual ~ReverbEngine() {}
+
+    // the delay memory is allocated here, not in the constructor: before the first Reverberate() and again
+    // whenever the host prepares (the memory is kept then and cleared); blocks are at most maxBlockSize long,
+    // the decay time set so far follows the new sample rate
+    virtual void Prepare(double sampleRate, int maxBlockSize) = 0;
+    // inputs and wetOutputs hold GetNumLanes() pointers each, the wet signal only is written
+    virtual void Reverberate(const float* const* inputs, float* const* wetOutputs, unsigned blockLength) = 0;
+    virtual void GenerateDelayValues(const std::vector<int>& powers) = 0; // allocates only after Prepare() and if the delays grow
+    virtual void SetDimension(Reverberator::FdnDimension dim) = 0;
+    virtual void Reset() = 0;
+    virtual void SetGain(float gain) = 0;
+    virtual void SetDecayTime(float rt60Seconds, double sampleRate) = 0;
+    virtual void SetModulation(float depthRadians, float rateHz, double sampleRate) = 0;
+
+    virtual int GetNumLanes() const = 0;
+    virtual double GetTailSamples() const = 0; // until -60 dB, infinity for a lossless network
+    virtual int GetLatencySamples() const { return 0; }
+    virtual size_t GetMemoryBytes() const = 0;
+
+    // the time to -60 dB of the slowest line, every line loses commonMatrixGain * lineGains[i] per pass
+    static double CalculateTailSamples(const std::vector<int>& delays, const std::vector<float>& lineGains);
+};
+
+// The engines the processor can run, the index of an engine is its value of the "engine" parameter.
+// The built-in engines are registered on the first use, others can be added before the first processor is created.
+class EngineRegistry
+{
+public:
+    using Factory = std::function<std::unique_ptr<ReverbEngine> (Reverberator::FdnDimension dim, const std::vector<int>& powers, int numLanes)>;
+
+    struct Entry
+    {
+        String name;
+        Factory create;
+    };
+
+    static void Register(const String& name, Factory create);
+    static const std::vector<Entry>& GetEngines();
+    static StringArray GetNames();
+    static std::unique_ptr<ReverbEngine> Create(int index, Reverberator::FdnDimension dim, const std::vector<int>& powers, int numLanes);
+
+private:
+    static std::vector<Entry>& GetEntries();
+};
@@ -11,63 +11,170 @@
 #include "Reverberator.h"
 #include "math.h"
 
-Reverberator::Reverberator(FdnDimension dim, const std::vector<int>& powers) :
+constexpr float Reverberator::bValue;
+constexpr float Reverberator::cValue;
+constexpr float Reverberator::commonMatrixGain;
+
+const std::vector<int> Reverberator::PrimesVector =
+{2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61, 67, 71, 73, 79, 83, 89, 97, 101};
+
+const std::vector<int> Reverberator::maxPowValues = []()
+{
+    std::vector<int> values;
+    for (auto &it : PrimesVector)
+        values.push_back(floor(std::log(MaxDelay)) / std::log(it));
+    return values;
+}();
+
+Reverberator::Reverberator(FdnDimension dim, const std::vector<int>& powers, DelayLayout layout) :
         dimension(dim),
+        requestedLayout(layout),
+        layout(layout),
         delayLines((std::size_t)dim, (std::size_t)dim, 0.f)
 {
-    CalculateMaxPowerValues();
     GenerateDelayValues(powers);
+    rotation.SetDimension((int)dim);
     
-    matrices.emplace(std::piecewise_construct,
-                     std::forward_as_tuple(FdnDimension::matrix2d),
-                     std::forward_as_tuple(2, commonMatrixGain * 1.f / std::sqrt(2.f)));
-    matrices.emplace(std::piecewise_construct,
-                     std::forward_as_tuple(FdnDimension::matrix4d),
-                     std::forward_as_tuple(4, commonMatrixGain * 0.5f));
-    matrices.emplace(std::piecewise_construct,
-                     std::forward_as_tuple(FdnDimension::matrix8d),
-                     std::forward_as_tuple(8, commonMatrixGain * 0.5f / std::sqrt(2.f)));
-    matrices.emplace(std::piecewise_construct,
-                     std::forward_as_tuple(FdnDimension::matrix16d),
-                     std::forward_as_tuple(16, commonMatrixGain * 0.25f));
+    for (auto dim : {FdnDimension::matrix2d, FdnDimension::matrix4d, FdnDimension::matrix8d, FdnDimension::matrix16d})
+        matrices.emplace(dim, CreateMixingMatrix(dim));
 }
 
-void Reverberator::GenerateDelayValues(const std::vector<int>& powers)
+std::vector<int> Reverberator::CalculateDelayValues(const std::vector<int>& powers, int firstPrime)
 {
-    delayValues.clear();
-    auto idxPrimes = 0;
+    jassert(firstPrime + powers.size() <= PrimesVector.size());
+    std::vector<int> delays;
+    auto idxPrimes = firstPrime;
     for (auto &it : powers)
     {
         auto power = (it % maxPowValues[idxPrimes]) ? (it % maxPowValues[idxPrimes]) : maxPowValues[idxPrimes];
         auto newDelayValue = std::pow(PrimesVector[idxPrimes++], power);
-        delayValues.push_back(newDelayValue);
+        delays.push_back(newDelayValue);
     }
-    std::sort(delayValues.begin(), delayValues.end());
+    std::sort(delays.begin(), delays.end());
+    return delays;
+}
+
+int Reverberator::GetMaxPower(int lineIdx)
+{
+    return maxPowValues[lineIdx];
+}
+
+std::vector<float> Reverberator::CalculateDecayGains(const std::vector<int>& delays, float rt60Seconds, double sampleRate)
+{
+    std::vector<float> gains;
+    CalculateDecayGains(delays, rt60Seconds, sampleRate, gains);
+    return gains;
+}
+
+void Reverberator::CalculateDecayGains(const std::vector<int>& delays, float rt60Seconds, double sampleRate, std::vector<float>& gains)
+{
+    // -60 dB after rt60Seconds on every path: a line loses 60 dB * delay / (rt60 * sampleRate) per pass,
+    // so all the modes decay at the same rate whatever the delays (Jot). The gain makes up for commonMatrixGain,
+    // the loss of the matrix is part of the pass already
+    gains.resize(delays.size());
+    for (size_t i = 0; i < delays.size(); ++i)
+        gains[i] = (rt60Seconds <= 0.f) ? 1.f : (float)std::pow(10.0, -3.0 * delays[i] / (rt60Seconds * sampleRate)) / commonMatrixGain;
+}
+
+HadamarMatrix Reverberator::CreateMixingMatrix(FdnDimension dim)
+{
+    // 1/sqrt(N) makes the Hadamard matrix orthonormal, commonMatrixGain makes it slightly lossy
+    auto N = (int)dim;
+    return HadamarMatrix(N, commonMatrixGain / std::sqrt((float)N));
+}
+
+void Reverberator::GenerateDelayValues(const std::vector<int>& powers)
+{
+    delayValues = CalculateDelayValues(powers);
+    feedbackVector.assign(delayValues.size(), 0.f);
+    mixedVector.assign(delayValues.size(), 0.f);
     UpdateDelayLines(delayValues.back());
+    CalculateDecayGains(delayValues, decayTime, decaySampleRate, decayGains);
+    UpdateLineGains();
     SetBVector(std::vector<float>((int)dimension, bValue));
     SetCVector(std::vector<float>((int)dimension, cValue));
 }
 
 void Reverberator::UpdateDelayLines(int maxDelayLength)
 {
-    delayLines.Resize((size_t)dimension, maxDelayLength, 0.f);
+    // the memory keeps its capacity, it is reallocated only when the new delays do not fit
+    // (or the layout changes with the dimension)
+    layout = (requestedLayout == DelayLayout::automatic) ? PreferredLayout(dimension) : requestedLayout;
+    delayDepth = maxDelayLength;
+    
+    if (layout == DelayLayout::interleaved)
+    {
+        delayLines.Clear();
+        auto requiredSize = (size_t)dimension * delayDepth;
+        if (requiredSize > delayFrames.capacity())
+            std::vector<float>(requiredSize, 0.f).swap(delayFrames);
+        else
+            delayFrames.resize(requiredSize);
+    }
+    else
+    {
+        std::vector<float>().swap(delayFrames);
+        delayLines.ReshapeDiscarding((size_t)dimension, delayDepth); // ClearReadRegions() clears what is read
+    }
+    ClearReadRegions();
     delayIdx = 0;
 }
 
-void Reverberator::CalculateMaxPowerValues()
+void Reverberator::ClearReadRegions()
 {
-    for (auto &it : PrimesVector)
-        maxPowValues.push_back(floor(std::log(MaxDelay)) / std::log(it));
+    // the writes start from delayIdx = 0, so the first delayValues[i] reads of the line i come from
+    // the end of its memory, everything else is written before it is read
+    const int N = (int)dimension;
+    for (auto i = 0; i < std::min(N, (int)delayValues.size()); ++i)
+    {
+        if (layout == DelayLayout::interleaved)
+        {
+            for (auto t = delayDepth - delayValues[i]; t < delayDepth; ++t)
+                delayFrames[t * N + i] = 0.f;
+        }
+        else
+            delayLines.Fill(i, delayDepth - delayValues[i], delayDepth, 0.f);
+    }
+}
+
+void Reverberator::Reset()
+{
+    ClearReadRegions();
+    delayIdx = 0;
+    rotation.Reset();
 }
 
 void Reverberator::SetDimension(FdnDimension dim)
 {
     dimension = dim;
+    rotation.SetDimension((int)dim);
 }
 
 void Reverberator::SetGain (float gain)
 {
     this->gain = gain;
+    UpdateLineGains();
+}
+
+void Reverberator::SetDecayTime(float rt60Seconds, double sampleRate)
+{
+    decayTime = rt60Seconds;
+    decaySampleRate = sampleRate;
+    CalculateDecayGains(delayValues, decayTime, decaySampleRate, decayGains);
+    UpdateLineGains();
+}
+
+void Reverberator::UpdateLineGains()
+{
+    // the attenuation of every line is folded into the one multiplication of the matrix output it has anyway
+    lineGains.resize(decayGains.size());
+    for (size_t i = 0; i < decayGains.size(); ++i)
+        lineGains[i] = gain * decayGains[i];
+}
+
+void Reverberator::SetModulation(float depthRadians, float rateHz, double sampleRate)
+{
+    rotation.SetModulation(depthRadians, rateHz, sampleRate);
 }
 
 void Reverberator::SetBVector(std::vector<float>&& b)
@@ -80,39 +187,111 @@ void Reverberator::SetCVector(std::vector<float>&& c)
     this->cVector = c;
 }
 
+Reverberator::DelayLayout Reverberator::GetLayout() const
+{
+    return layout;
+}
+
+float Reverberator::GetStateEnergy() const
+{
+    // the last delayValues[i] writes of the line i, the older samples are never read again
+    const int N = (int)dimension;
+    auto energy = 0.0;
+    for (auto i = 0; i < std::min(N, (int)delayValues.size()); ++i)
+    {
+        for (auto t = 1; t <= delayValues[i]; ++t)
+        {
+            auto idx = (delayIdx - t < 0) ? delayIdx - t + delayDepth : delayIdx - t;
+            auto value = (layout == DelayLayout::interleaved) ? delayFrames[idx * N + i] : delayLines.Get(i, idx);
+            energy += value * value;
+        }
+    }
+    return (float)energy;
+}
+
+size_t Reverberator::GetMemoryBytes() const
+{
+    return delayFrames.capacity() * sizeof(float) + delayLines.GetMemoryBytes();
+}
+
+Reverberator::DelayLayout Reverberator::PreferredLayout(FdnDimension dim)
+{
+    // measured per dimension with the longest delays and the delay memory out of cache:
+    // up to 8 lines the frames are faster (one cache line per write-back), a 16-lines frame
+    // fills the whole cache line, so every tap read would touch a new line and the rows win
+    return (dim == FdnDimension::matrix16d) ? DelayLayout::perLine : DelayLayout::interleaved;
+}
+
 void Reverberator::Reverberate(float* audioData, unsigned blockLength, float drywet)
 {
-    int N = (int)dimension;
-    jassert(N == delayValues.size());
+    float dry[MixChunkLength];
+    
+    for (unsigned start = 0; start < blockLength; start += MixChunkLength)
+    {
+        auto chunkLength = std::min((unsigned)MixChunkLength, blockLength - start);
+        auto* chunk = audioData + start;
+        std::copy(chunk, chunk + chunkLength, dry);
+        Reverberate(dry, chunk, chunkLength);
+        for (auto n = 0; n < chunkLength; ++n)
+            chunk[n] = drywet * chunk[n] + (1.f - drywet) * dry[n];
+    }
+}
+
+void Reverberator::Reverberate(const float* input, float* wetOutput, unsigned blockLength)
+{
+    jassert((int)dimension == delayValues.size());
+    
+    currentMatrix = &matrices.at(dimension); // looked up per block, the pointer would not survive a copy of the object
     
-    int delayDepth = (int)delayLines.GetDimensions().second; // signed type is better whith delayedIdx calculation
+    if (layout == DelayLayout::interleaved)
+        RenderWet<DelayLayout::interleaved>(input, wetOutput, blockLength);
+    else
+        RenderWet<DelayLayout::perLine>(input, wetOutput, blockLength);
+    
+    if (rotation.IsActive())
+        rotation.Advance(blockLength);
+}
+
+template <Reverberator::DelayLayout layout>
+void Reverberator::RenderWet(const float* input, float* wetOutput, unsigned blockLength)
+{
+    const int N = (int)dimension;
+    float* tmp = feedbackVector.data();
+    float* mixed = mixedVector.data();
+    const bool rotate = rotation.IsActive();
     
     for (auto n = 0; n < blockLength; ++n)
     {
-        float input = audioData[n];
-        float output = audioData[n];
-        
-        std::vector<float> tmp(N, 0.f);
+        float inputSample = input[n];
+        float output = inputSample;
         
         for (auto i = 0; i < N; ++i)
         {
-            auto delayed_idx = (delayIdx - delayValues[i] + delayDepth) % delayDepth;
-            tmp[i] = delayLines.Get(i, delayed_idx);
+            auto delayedIdx = delayIdx - delayValues[i];
+            if (delayedIdx < 0)
+                delayedIdx += delayDepth;
+            tmp[i] = (layout == DelayLayout::interleaved) ? delayFrames[delayedIdx * N + i] : delayLines.Get(i, delayedIdx);
             output += cVector[i] * tmp[i];
         }
         output /= (float)N; //trying to prevent overdrive, heuristics...
         
+        if (rotate)
+            rotation.Apply<1>(tmp);
+        
+        currentMatrix->Multiply(tmp, mixed);
+        float* frame = (layout == DelayLayout::interleaved) ? &delayFrames[delayIdx * N] : nullptr;
         for (auto i = 0; i < N; ++i)
         {
-            float dotMultiplication = 0.f;
-            for (auto j = 0; j < N; ++j)
-                dotMultiplication += tmp[j] * matrices.at(dimension).Get(i,j);
-            delayLines.Set(i, delayIdx, input * bVector[i] + dotMultiplication);
+            auto newValue = inputSample * bVector[i] + lineGains[i] * mixed[i];
+            if (layout == DelayLayout::interleaved)
+                frame[i] = newValue;
+            else
+                delayLines.Set(i, delayIdx, std::move(newValue));
         }
         
-        audioData[n] = drywet * output + (1.f - drywet) * input;
+        wetOutput[n] = output;
         
-        delayIdx = (delayIdx + 1) % delayDepth;
+        if (++delayIdx == delayDepth)
+            delayIdx = 0;
     }
-    
 }
@@ -14,6 +14,7 @@
 #include "vector"
 
 #include "Matrix.h"
+#include "FeedbackRotation.h"
 
 
 class Reverberator
@@ -24,40 +25,77 @@ public:
         matrix2d = 2, matrix4d = 4, matrix8d = 8, matrix16d = 16
     };
     
-    Reverberator(FdnDimension dim, const std::vector<int>& powers);
+    enum class DelayLayout
+    {
+        perLine,     // one row of the delay memory per line
+        interleaved, // time-major frames of N floats, the feedback vector is written back with one contiguous store
+        automatic    // the faster layout for the current dimension (see PreferredLayout())
+    };
+    
+    Reverberator(FdnDimension dim, const std::vector<int>& powers, DelayLayout layout = DelayLayout::automatic);
     ~Reverberator() {};
     
     void Reverberate(float* audioData, unsigned blockLength, float drywet = 0.5f);
+    void Reverberate(const float* input, float* wetOutput, unsigned blockLength); // writes the wet signal only
     void GenerateDelayValues(const std::vector<int>& powers);
+    void Reset(); // clears the network state, so the next render starts from silence
     void SetDimension(FdnDimension dim);
     void SetGain (float gain);
+    void SetDecayTime(float rt60Seconds, double sampleRate); // per-line attenuation for the given RT60, 0 turns it off
+    void SetModulation(float depthRadians, float rateHz, double sampleRate); // time-varying feedback matrix, off by default
     void SetBVector(std::vector<float>&& b);
     void SetCVector(std::vector<float>&& c);
     
+    DelayLayout GetLayout() const;
+    float GetStateEnergy() const; // of the samples the lines still have to output, 0 once the network is silent
+    size_t GetMemoryBytes() const; // of the delay memory
+    static DelayLayout PreferredLayout(FdnDimension dim);
+    
+    // sorted delays in samples, the line i is a power of the prime number firstPrime + i
+    static std::vector<int> CalculateDelayValues(const std::vector<int>& powers, int firstPrime = 0);
+    static HadamarMatrix CreateMixingMatrix(FdnDimension dim);
+    static int GetMaxPower(int lineIdx); // powers above it are wrapped around (see CalculateDelayValues())
+    static std::vector<float> CalculateDecayGains(const std::vector<int>& delays, float rt60Seconds, double sampleRate);
+    static void CalculateDecayGains(const std::vector<int>& delays, float rt60Seconds, double sampleRate, std::vector<float>& gains); // in place, no allocation once gains have the capacity
+    
+    static constexpr float bValue = 1.f;
+    static constexpr float cValue = 0.8f;
+    static constexpr float commonMatrixGain = 0.97f;
+    static const int MaxDelay = 50000;
+    
 private:
+    template <DelayLayout layout> void RenderWet(const float* input, float* wetOutput, unsigned blockLength);
     void UpdateDelayLines(int maxDelayLength);
-    void CalculateMaxPowerValues();
+    void ClearReadRegions();
+    void UpdateLineGains();
     
     FdnDimension dimension;
-    Matrix<float> delayLines;
+    const DelayLayout requestedLayout;
+    DelayLayout layout;
+    Matrix<float> delayLines;    // used by the perLine layout
+    std::vector<float> delayFrames; // used by the interleaved layout
+    std::vector<float> feedbackVector; // the delay lines outputs of the current sample
+    std::vector<float> mixedVector; // the mixing matrix times feedbackVector
     std::vector<int> delayValues;
-    float gain = 0.8f;
+    float gain = 1.f; // additional feedback gain on top of commonMatrixGain, controls the decay
+    float decayTime = 0.f; // RT60 in seconds, 0 if the decay is set by the gains only
+    double decaySampleRate = 44100.0;
+    std::vector<float> decayGains; // per line, from decayTime and the delays
+    std::vector<float> lineGains; // per line, gain times decayGains, applied to the matrix output
     std::vector<float> bVector;
     std::vector<float> cVector;
-    std::vector<int> maxPowValues; // the restriction to prevent the creation of very long delays (calculates based on the MaxDelay value)
     int delayIdx = 0;
+    int delayDepth = 0;
     
     std::map<FdnDimension, const HadamarMatrix> matrices;
+    FeedbackRotation rotation;
     
     const HadamarMatrix* currentMatrix = nullptr;
     
-    const float bValue = 1.f;
-    const float cValue = 0.8f;
-    const float commonMatrixGain = 0.97f;
+    static const std::vector<int> PrimesVector;
+    static const std::vector<int> maxPowValues; // the restriction to prevent the creation of very long delays (calculates based on the MaxDelay value)
     
-    const std::vector<int> PrimesVector =
-    {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61, 67, 71, 73, 79, 83, 89, 97, 101};
     
-    const int MaxDelay = 50000;
+    static const int MixChunkLength = 64;
 
 };
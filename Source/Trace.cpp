@@ -0,0 +1,111 @@
+/*
+  ==============================================================================
+
+    Trace.cpp
+    Created: 19 Oct 2026 2:40:18pm
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#include "Trace.h"
+
+#if FDN_ENABLE_TRACE
+
+TraceRecorder::ThreadBuffer* TraceRecorder::getBuffers()
+{
+    static ThreadBuffer buffers[MaxThreads];
+    return buffers;
+}
+
+struct TraceRecorder::ThreadSlot
+{
+    ~ThreadSlot()
+    {
+        // the events stay for the export until another thread claims the buffer
+        if (buffer != nullptr)
+            buffer->claimed.store(false, std::memory_order_release);
+    }
+
+    ThreadBuffer* buffer = nullptr;
+};
+
+TraceRecorder::ThreadBuffer* TraceRecorder::getBufferForThisThread()
+{
+    thread_local ThreadSlot slot;
+    if (slot.buffer != nullptr)
+        return slot.buffer;
+
+    // one of the static buffers is claimed, nothing is allocated. The empty ones go first, the events of
+    // the exited threads are overwritten only after that; while all of them are taken the events are dropped
+    // and every next marker tries again
+    auto* buffers = getBuffers();
+    for (auto reuse : { false, true })
+    {
+        for (auto i = 0; i < MaxThreads; ++i)
+        {
+            bool expected = false;
+            if ((reuse || buffers[i].writeIdx.load() == 0) && buffers[i].claimed.compare_exchange_strong(expected, true))
+            {
+                auto* messageManager = MessageManager::getInstanceWithoutCreating();
+                buffers[i].isMessageThread = (messageManager != nullptr && messageManager->isThisTheMessageThread());
+                buffers[i].writeIdx.store(0, std::memory_order_release);
+                slot.buffer = &buffers[i];
+                return slot.buffer;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void TraceRecorder::claimThreadBuffer()
+{
+    getBufferForThisThread();
+}
+
+void TraceRecorder::record(const char* name, int64 startMicroseconds, int64 endMicroseconds)
+{
+    auto* buffer = getBufferForThisThread();
+    if (buffer == nullptr)
+        return;
+    
+    auto idx = buffer->writeIdx.load(std::memory_order_relaxed);
+    buffer->events[idx & EventsMask] = { name, startMicroseconds, endMicroseconds };
+    buffer->writeIdx.store(idx + 1, std::memory_order_release);
+}
+
+bool TraceRecorder::exportChromeTrace(const File& file)
+{
+    // the events being written during the export can be torn, that is acceptable for a diagnostic dump
+    String json = "{\"traceEvents\":[\n";
+    auto first = true;
+    auto* buffers = getBuffers();
+    
+    for (auto tid = 0; tid < MaxThreads; ++tid)
+    {
+        auto& buffer = buffers[tid];
+        auto writeIdx = buffer.writeIdx.load(std::memory_order_acquire);
+        if (writeIdx == 0)
+            continue;
+        
+        auto threadName = buffer.isMessageThread ? String("Message thread") : "Thread " + String(tid);
+        json << (first ? "" : ",\n")
+             << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+             << ",\"args\":{\"name\":\"" << threadName << "\"}}";
+        first = false;
+        
+        auto readIdx = (writeIdx > EventsMask + 1) ? writeIdx - (EventsMask + 1) : 0;
+        for (; readIdx != writeIdx; ++readIdx)
+        {
+            const auto& event = buffer.events[readIdx & EventsMask];
+            json << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+                 << ",\"ts\":" << event.startMicroseconds
+                 << ",\"dur\":" << (event.endMicroseconds - event.startMicroseconds) << "}";
+        }
+    }
+    json << "\n]}\n";
+    
+    return file.replaceWithText(json);
+}
+
+#endif
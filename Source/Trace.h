@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+    Trace.h
+    Created: 19 Oct 2026 2:40:18pm
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "atomic"
+#include "chrono"
+
+// Scoped timeline markers for the audio and the message threads.
+// Every thread writes into its own ring buffer without locks, exportChromeTrace() writes everything
+// recorded so far as Chrome/Perfetto trace JSON. A thread claims one of the MaxThreads buffers at its first
+// marker and gives it back when it exits. The first use of the thread_local that holds it can allocate
+// in a dynamically loaded plugin, so the threads with deadlines claim it up front (FDN_TRACE_CLAIM_THREAD).
+// The markers are compiled out unless FDN_ENABLE_TRACE is set (it is on by default in debug builds).
+
+#ifndef FDN_ENABLE_TRACE
+ #if JUCE_DEBUG
+  #define FDN_ENABLE_TRACE 1
+ #else
+  #define FDN_ENABLE_TRACE 0
+ #endif
+#endif
+
+#if FDN_ENABLE_TRACE
+
+class TraceRecorder
+{
+public:
+    struct Event
+    {
+        const char* name; // has to be a string literal
+        int64 startMicroseconds;
+        int64 endMicroseconds;
+    };
+
+    class ScopedMarker
+    {
+    public:
+        ScopedMarker(const char* name) : name(name), start(now()) {};
+        ~ScopedMarker() { record(name, start, now()); };
+
+    private:
+        const char* name;
+        const int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedMarker)
+    };
+
+    static void record(const char* name, int64 startMicroseconds, int64 endMicroseconds);
+    static void claimThreadBuffer(); // the first marker of the thread does it otherwise
+    static bool exportChromeTrace(const File& file);
+
+    static int64 now()
+    {
+        using namespace std::chrono;
+        return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    struct ThreadBuffer
+    {
+        std::atomic<bool> claimed { false }; // by a running thread, the events stay after it exits
+        std::atomic<uint32_t> writeIdx { 0 };
+        bool isMessageThread = false;
+        Event events[1 << 13];
+    };
+
+    struct ThreadSlot; // the thread_local owner, releases the buffer when its thread exits
+
+    static ThreadBuffer* getBuffers(); // MaxThreads buffers
+    static ThreadBuffer* getBufferForThisThread();
+
+    static const int MaxThreads = 16;
+    static const uint32_t EventsMask = (1 << 13) - 1;
+};
+
+ #define FDN_TRACE_CONCAT_(a, b) a ## b
+ #define FDN_TRACE_CONCAT(a, b) FDN_TRACE_CONCAT_(a, b)
+ #define FDN_TRACE_SCOPE(name) TraceRecorder::ScopedMarker FDN_TRACE_CONCAT(traceMarker, __LINE__) (name)
+ #define FDN_TRACE_CLAIM_THREAD() TraceRecorder::claimThreadBuffer()
+
+#else
+
+ #define FDN_TRACE_SCOPE(name)
+ #define FDN_TRACE_CLAIM_THREAD()
+
+#endif
@@ -0,0 +1,131 @@
+/*
+  ==============================================================================
+
+    VelvetDecorrelator.cpp
+    Created: 25 Oct 2026 2:34:18pm
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#include "VelvetDecorrelator.h"
+#include "random"
+
+void VelvetDecorrelator::Prepare(double sampleRate, int maxBlockLength, int numLanes)
+{
+    jassert(numLanes > 0 && numLanes <= MaxLanes);
+    this->numLanes = numLanes;
+
+    // a fixed seed per channel, the sound does not change from one session to the next
+    auto gridLength = sampleRate / TapsPerSecond;
+    for (auto k = 0; k < numLanes; ++k)
+    {
+        std::mt19937 random (1234u + (uint32)k);
+        std::uniform_real_distribution<double> position (0.0, 1.0);
+        taps[k].positive.clear();
+        taps[k].negative.clear();
+        for (auto m = 0; m < NumTaps; ++m)
+        {
+            auto delay = (int)((m + position(random)) * gridLength);
+            auto& it = (random() & 1) ? taps[k].positive : taps[k].negative;
+            it.push_back(delay);
+        }
+    }
+
+    auto historyLength = nextPowerOfTwo((int)(NumTaps * gridLength) + 1 + maxBlockLength);
+    historyMask = historyLength - 1;
+    history.assign((size_t)historyLength * numLanes, 0.f);
+    writePosition = 0;
+    filtered.assign((size_t)maxBlockLength, 0.f);
+    dryRamp.assign((size_t)maxBlockLength, 0.f);
+    wetRamp.assign((size_t)maxBlockLength, 0.f);
+    mix.reset(sampleRate, FadeSeconds);
+    mix.setCurrentAndTargetValue(0.f);
+}
+
+void VelvetDecorrelator::SetActive(bool shouldBeActive)
+{
+    if (shouldBeActive && ! IsActive())
+    {
+        Reset(); // the history is not updated while the stage is off
+        mix.setCurrentAndTargetValue(0.f);
+    }
+    mix.setTargetValue(shouldBeActive ? 1.f : 0.f);
+}
+
+void VelvetDecorrelator::Reset()
+{
+    std::fill(history.begin(), history.end(), 0.f);
+    writePosition = 0;
+}
+
+void VelvetDecorrelator::Release()
+{
+    std::vector<float>().swap(history);
+    std::vector<float>().swap(filtered);
+    std::vector<float>().swap(dryRamp);
+    std::vector<float>().swap(wetRamp);
+    historyMask = 0;
+    writePosition = 0;
+}
+
+bool VelvetDecorrelator::IsActive() const
+{
+    return mix.getTargetValue() > 0.f || mix.isSmoothing();
+}
+
+void VelvetDecorrelator::Process(float* const* channels, unsigned blockLength)
+{
+    const int historyLength = historyMask + 1;
+    const int length = (int)blockLength;
+    const float level = 1.f / std::sqrt((float)NumTaps); // the taps are not correlated, their powers add up
+
+    // while the stage is switched the filter goes to its own buffer and is mixed with the signal
+    auto fading = mix.isSmoothing();
+    if (fading)
+    {
+        for (auto n = 0; n < length; ++n)
+        {
+            auto value = mix.getNextValue();
+            dryRamp[(size_t)n] = 1.f - value;
+            wetRamp[(size_t)n] = value * level;
+        }
+    }
+
+    for (auto k = 0; k < numLanes; ++k)
+    {
+        // the block is written first, so the taps shorter than the block read from it as well
+        float* channelHistory = &history[(size_t)k * historyLength];
+        auto firstRun = jmin(length, historyLength - writePosition);
+        FloatVectorOperations::copy(channelHistory + writePosition, channels[k], firstRun);
+        FloatVectorOperations::copy(channelHistory, channels[k] + firstRun, length - firstRun);
+
+        float* output = fading ? filtered.data() : channels[k];
+        FloatVectorOperations::clear(output, length);
+        for (auto delay : taps[k].positive)
+        {
+            auto readPosition = (writePosition - delay) & historyMask;
+            auto run = jmin(length, historyLength - readPosition);
+            FloatVectorOperations::add(output, channelHistory + readPosition, run);
+            FloatVectorOperations::add(output + run, channelHistory, length - run);
+        }
+        for (auto delay : taps[k].negative)
+        {
+            auto readPosition = (writePosition - delay) & historyMask;
+            auto run = jmin(length, historyLength - readPosition);
+            FloatVectorOperations::subtract(output, channelHistory + readPosition, run);
+            FloatVectorOperations::subtract(output + run, channelHistory, length - run);
+        }
+        if (fading)
+        {
+            FloatVectorOperations::multiply(channels[k], dryRamp.data(), length);
+            FloatVectorOperations::addWithMultiply(channels[k], output, wetRamp.data(), length);
+        }
+        else
+        {
+            FloatVectorOperations::multiply(output, level, length);
+        }
+    }
+
+    writePosition = (writePosition + length) & historyMask;
+}
@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+    VelvetDecorrelator.h
+    Created: 25 Oct 2026 2:34:18pm
+    Author:  Ekaterina Poklonskaya
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "array"
+#include "vector"
+
+// Decorrelates the channels of the wet signal with short velvet noise filters: NumTaps taps of +1 or -1,
+// one at a random position in every grid cell, different for every channel. A tap over a block is one or two
+// contiguous adds or subtracts of the channel history (like the taps of EarlyReflections), so the whole
+// filter costs NumTaps additions per sample and one multiplication for the level.
+// The channels keep their spectra and get independent fine structures, one network sounds wide.
+// Turning the stage on or off crossfades between the signal and the filtered one over FadeSeconds.
+class VelvetDecorrelator
+{
+public:
+    static const int MaxLanes = 8;
+    static const int NumTaps = 30;
+
+    void Prepare(double sampleRate, int maxBlockLength, int numLanes);
+    void SetActive(bool shouldBeActive); // off takes effect once the crossfade has finished
+    void Reset();
+    void Release(); // frees the memory until the next Prepare()
+    bool IsActive() const;
+
+    // in place, channels holds numLanes pointers
+    void Process(float* const* channels, unsigned blockLength);
+
+private:
+    struct Taps
+    {
+        std::vector<int> positive; // delays of the +1 taps
+        std::vector<int> negative; // delays of the -1 taps
+    };
+
+    int numLanes = 1;
+    std::array<Taps, MaxLanes> taps;
+    std::vector<float> history; // a ring per channel, historyMask + 1 samples each
+    int historyMask = 0;
+    int writePosition = 0;
+    LinearSmoothedValue<float> mix; // 0 the signal as it is, 1 the filtered one
+    std::vector<float> filtered; // one channel of the block, while the crossfade runs only
+    std::vector<float> dryRamp;
+    std::vector<float> wetRamp;
+
+    const double TapsPerSecond = 1500.0; // the density of the noise, NumTaps of it last 20 ms
+    const double FadeSeconds = 0.01;
+};
@@ -0,0 +1,172 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 28 Oct 2026 10:12:36am
+    Author:  Ekaterina Poklonskaya
+
+    Block size stress test of the plugin processor.
+    Renders the same input and the same dry/wet CC events once in blocks of the prepared length
+    (the reference) and then several times in random blocks from 0 to that length,
+    every output has to match the reference. Exits with 1 on a mismatch.
+    The modulation is left at 0, its angles move once per block by design (see FeedbackRotation).
+    Usage: BlockStress [--block 512] [--rate 48000] [--seconds 10] [--dimension 8] [--runs 4]
+                       [--seed 1] [--tolerance 1e-6] [--pipelined]
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "../../../Source/PluginProcessor.h"
+#include "random"
+
+static String getOption(const StringArray& args, const String& name, const String& defaultValue)
+{
+    auto idx = args.indexOf(name);
+    return (idx >= 0 && idx + 1 < args.size()) ? args[idx + 1] : defaultValue;
+}
+
+struct Settings
+{
+    int maxBlockLength;
+    double sampleRate;
+    Reverberator::FdnDimension dimension;
+    bool pipelined;
+};
+
+struct ControllerEvent
+{
+    int position; // from the start of the render
+    int value;
+};
+
+static void setParameter(FdnReverberationNewAudioProcessor& processor, const String& id, float value)
+{
+    auto* parameter = processor.getParameters().getParameter(id);
+    parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+}
+
+// blockLengths returns the length of the next block, the render stops once the input is used up
+static AudioBuffer<float> render(const Settings& settings, const AudioBuffer<float>& input, const std::vector<ControllerEvent>& events,
+                                 std::function<int()> blockLengths)
+{
+    FdnReverberationNewAudioProcessor processor;
+    processor.setPlayConfigDetails(2, 2, settings.sampleRate, settings.maxBlockLength);
+    processor.setDimension(settings.dimension);
+    std::vector<int> powers;
+    for (auto line = 0; line < (int)settings.dimension; ++line)
+        powers.push_back(1 + line % 3);
+    processor.setDelayPowers(powers);
+
+    // every stage that keeps state between the blocks is on
+    setParameter(processor, "early", 40.0f);
+    setParameter(processor, "diffusion", 60.0f);
+    setParameter(processor, "multiband", 1.0f);
+    setParameter(processor, "lowdecay", 0.95f);
+    setParameter(processor, "decorrelation", 1.0f);
+    setParameter(processor, "pipelined", settings.pipelined ? 1.0f : 0.0f);
+    processor.prepareToPlay(settings.sampleRate, settings.maxBlockLength);
+
+    const auto numSamples = input.getNumSamples();
+    AudioBuffer<float> output (2, numSamples);
+    AudioBuffer<float> block (2, settings.maxBlockLength);
+    MidiBuffer midi;
+    size_t nextEvent = 0;
+    for (auto start = 0; start < numSamples; )
+    {
+        auto length = jmin(blockLengths(), numSamples - start);
+        block.setSize(2, length, false, false, true);
+        for (auto channel = 0; channel < 2; ++channel)
+            block.copyFrom(channel, 0, input, channel, start, length);
+
+        midi.clear();
+        for (; nextEvent < events.size() && events[nextEvent].position < start + length; ++nextEvent)
+            midi.addEvent(MidiMessage::controllerEvent(1, 91, events[nextEvent].value), events[nextEvent].position - start);
+
+        processor.processBlock(block, midi);
+        for (auto channel = 0; channel < 2; ++channel)
+            output.copyFrom(channel, start, block, channel, 0, length);
+        start += length;
+    }
+    processor.releaseResources();
+    return output;
+}
+
+int main (int argc, char* argv[])
+{
+    StringArray args;
+    for (auto i = 1; i < argc; ++i)
+        args.add(argv[i]);
+
+    Settings settings;
+    settings.maxBlockLength = getOption(args, "--block", "512").getIntValue();
+    settings.sampleRate = getOption(args, "--rate", "48000").getDoubleValue();
+    settings.dimension = (Reverberator::FdnDimension)getOption(args, "--dimension", "8").getIntValue();
+    settings.pipelined = args.contains("--pipelined");
+    auto seconds = getOption(args, "--seconds", "10").getDoubleValue();
+    auto numRuns = getOption(args, "--runs", "4").getIntValue();
+    auto tolerance = getOption(args, "--tolerance", "1e-6").getFloatValue();
+    std::mt19937 random ((uint32)getOption(args, "--seed", "1").getIntValue());
+
+    auto dim = (int)settings.dimension;
+    if (dim != 2 && dim != 4 && dim != 8 && dim != 16)
+    {
+        std::cerr << "The dimension has to be 2, 4, 8 or 16" << std::endl;
+        return 1;
+    }
+
+    // noise bursts with silent gaps, so the tails are compared as well as the direct signal
+    auto numSamples = (int)(seconds * settings.sampleRate);
+    AudioBuffer<float> input (2, numSamples);
+    std::uniform_real_distribution<float> noise (-0.5f, 0.5f);
+    for (auto n = 0; n < numSamples; ++n)
+    {
+        auto burst = (n / (int)(0.25 * settings.sampleRate)) % 4 == 0;
+        for (auto channel = 0; channel < 2; ++channel)
+            input.setSample(channel, n, burst ? noise(random) : 0.0f);
+    }
+
+    std::vector<ControllerEvent> events;
+    for (auto position = 0; position < numSamples; position += 1 + (int)(random() % (uint32)(0.3 * settings.sampleRate)))
+        events.push_back({ position, (int)(random() % 128) });
+
+    auto maxBlockLength = settings.maxBlockLength;
+    auto reference = render(settings, input, events, [maxBlockLength]() { return maxBlockLength; });
+
+    auto failed = false;
+    for (auto run = 0; run < numRuns; ++run)
+    {
+        // the lengths 0, 1 and the maximum come up more often than the others, hosts send them
+        auto output = render(settings, input, events, [&random, maxBlockLength]()
+        {
+            switch (random() % 8)
+            {
+                case 0:  return 0;
+                case 1:  return 1;
+                case 2:  return maxBlockLength;
+                default: return (int)(random() % (uint32)maxBlockLength) + 1;
+            }
+        });
+
+        auto maxDifference = 0.0f;
+        auto firstMismatch = -1;
+        for (auto channel = 0; channel < 2; ++channel)
+        {
+            for (auto n = 0; n < numSamples; ++n)
+            {
+                auto difference = std::abs(output.getSample(channel, n) - reference.getSample(channel, n));
+                if (difference > tolerance && (firstMismatch < 0 || n < firstMismatch))
+                    firstMismatch = n;
+                maxDifference = jmax(maxDifference, difference);
+            }
+        }
+        std::cout << "run " << run << ": largest difference " << maxDifference;
+        if (firstMismatch >= 0)
+            std::cout << ", first mismatch at sample " << firstMismatch;
+        std::cout << std::endl;
+        failed = failed || firstMismatch >= 0;
+    }
+
+    std::cout << (failed ? "FAILED" : "passed") << std::endl;
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 20 Oct 2026 3:52:10pm
+    Author:  Ekaterina Poklonskaya
+
+    Headless search for the best delay powers of a network.
+    Usage: DelayOptimiser [--dimension 2|4|8|16] [--candidates N] [--results N]
+                          [--length-ms N] [--threads N] [--seed N] [--output presets.xml]
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "../../../Source/DelaySetOptimiser.h"
+
+static String getOption(const StringArray& args, const String& name, const String& defaultValue)
+{
+    auto idx = args.indexOf(name);
+    return (idx >= 0 && idx + 1 < args.size()) ? args[idx + 1] : defaultValue;
+}
+
+int main (int argc, char* argv[])
+{
+    StringArray args;
+    for (auto i = 1; i < argc; ++i)
+        args.add(argv[i]);
+
+    DelaySetOptimiser::Settings settings;
+    settings.dimension = (Reverberator::FdnDimension)getOption(args, "--dimension", "8").getIntValue();
+    settings.numCandidates = getOption(args, "--candidates", "20000").getIntValue();
+    settings.numResults = getOption(args, "--results", "10").getIntValue();
+    settings.irLengthSeconds = getOption(args, "--length-ms", "200").getDoubleValue() / 1000.0;
+    settings.numThreads = getOption(args, "--threads", "0").getIntValue();
+    settings.seed = (uint32)getOption(args, "--seed", "1").getIntValue();
+
+    auto dim = (int)settings.dimension;
+    if (dim != 2 && dim != 4 && dim != 8 && dim != 16)
+    {
+        std::cerr << "The dimension has to be 2, 4, 8 or 16" << std::endl;
+        return 1;
+    }
+
+    DelaySetOptimiser optimiser (settings);
+    auto startTime = Time::getMillisecondCounterHiRes();
+    auto results = optimiser.run();
+    auto elapsedSeconds = (Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+
+    std::cout << optimiser.getNumCandidates() << " candidates in " << elapsedSeconds << " s" << std::endl;
+
+    XmlElement presets ("FdnPresets");
+    presets.setAttribute("dimension", dim);
+    for (auto &it : results)
+    {
+        StringArray powers;
+        for (auto power : it.powers)
+            powers.add(String(power));
+
+        std::cout << powers.joinIntoString(" ") << "\tscore " << it.score << "\techo density " << it.echoDensity
+                  << "\tflatness " << it.flatness << "\tmemory " << it.memoryCost << std::endl;
+
+        auto* preset = presets.createNewChildElement("Preset");
+        preset->setAttribute("powers", powers.joinIntoString(" "));
+        preset->setAttribute("score", it.score);
+    }
+
+    auto output = getOption(args, "--output", "");
+    if (output.isNotEmpty() && ! presets.writeToFile(File::getCurrentWorkingDirectory().getChildFile(output), {}))
+    {
+        std::cerr << "Cannot write " << output << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,319 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 29 Oct 2026 2:17:45pm
+    Author:  Ekaterina Poklonskaya
+
+    Golden output test of the networks.
+    The references are the impulse and the noise responses of the scalar Reverberator for every FdnDimension
+    and a few delay power sets, stored in References/ (--generate writes them again).
+    Every other engine of the EngineRegistry renders the same inputs in uneven blocks with 1, 2, 3 and 8 lanes
+    (every lane stride of the batch kernels) and has to match the references within the tolerance.
+    The Scalar engine runs the reference code itself, it only checks that the references are up to date.
+    Without --isa the test runs itself once per instruction set level (FDN_ISA_LEVEL, see DspKernels.h),
+    a level the CPU or the build does not have is skipped. Exits with 1 on a mismatch or a missing reference.
+    Tools/run_tests.sh builds and runs it on Linux.
+    Usage: GoldenTest [--references References] [--tolerance 1e-5] [--isa generic|sse42|avx2|avx512] [--generate]
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "../../../Source/BatchReverberator.h"
+#include "../../../Source/DspKernels.h"
+#include "array"
+#include "stdlib.h"
+
+static const double SampleRate = 48000.0;
+static const float DecayTime = 1.0f;
+static const int Length = 4096;
+static const int MaxBlockLength = 1024;
+static const int BlockLengths[] = { 512, 1, 37, 256, 1024, 63 }; // cycled, the odd ones leave the vector loops a remainder
+static const int LaneCounts[] = { 1, 2, 3, 8 };
+static const int FileMagic = 0x54474446; // "FDGT"
+static const int FileVersion = 1;
+static const char* const ReferenceEngine = "Scalar"; // the ScalarEngine lanes are the Reverberator of the references
+
+struct TestCase
+{
+    Reverberator::FdnDimension dimension;
+    String setName;
+    std::vector<int> powers;
+};
+
+static String getOption(const StringArray& args, const String& name, const String& defaultValue)
+{
+    auto idx = args.indexOf(name);
+    return (idx >= 0 && idx + 1 < args.size()) ? args[idx + 1] : defaultValue;
+}
+
+static std::vector<TestCase> getTestCases()
+{
+    // the patterns are repeated over the lines: the plain primes (many passes in the rendered length),
+    // and two sets with longer lines up to a few thousand samples
+    const std::vector<std::pair<String, std::vector<int>>> patterns =
+    {
+        { "primes", { 1 } },
+        { "mixed", { 1, 2, 3 } },
+        { "default", { 1, 2, 3, 4 } }
+    };
+
+    std::vector<TestCase> cases;
+    for (auto dim : { Reverberator::FdnDimension::matrix2d, Reverberator::FdnDimension::matrix4d,
+                      Reverberator::FdnDimension::matrix8d, Reverberator::FdnDimension::matrix16d })
+    {
+        for (auto &it : patterns)
+        {
+            TestCase testCase { dim, it.first, {} };
+            for (auto line = 0; line < (int)dim; ++line)
+                testCase.powers.push_back(it.second[(size_t)line % it.second.size()]);
+            cases.push_back(testCase);
+        }
+    }
+    return cases;
+}
+
+static File getReferenceFile(const File& directory, const TestCase& testCase)
+{
+    return directory.getChildFile("d" + String((int)testCase.dimension) + "_" + testCase.setName + ".golden");
+}
+
+// [0] is the impulse, [1] the noise, the same for every run
+static std::array<std::vector<float>, 2> createInputs()
+{
+    std::array<std::vector<float>, 2> inputs;
+    inputs[0].assign(Length, 0.f);
+    inputs[0][0] = 1.f;
+    // a generator of its own, the references must not change with the JUCE version
+    uint32 state = 28;
+    inputs[1].resize(Length);
+    for (auto &it : inputs[1])
+    {
+        state = state * 1664525u + 1013904223u;
+        it = (float)(state >> 8) / (float)(1 << 23) - 1.f;
+    }
+    return inputs;
+}
+
+static std::array<std::vector<float>, 2> renderReference(const TestCase& testCase)
+{
+    auto inputs = createInputs();
+    std::array<std::vector<float>, 2> outputs;
+    for (auto input = 0; input < 2; ++input)
+    {
+        Reverberator reverberator (testCase.dimension, testCase.powers);
+        reverberator.SetDecayTime(DecayTime, SampleRate);
+        outputs[input].resize(Length);
+        for (auto start = 0, blockIdx = 0; start < Length; ++blockIdx)
+        {
+            auto length = jmin(BlockLengths[blockIdx % numElementsInArray(BlockLengths)], Length - start);
+            reverberator.Reverberate(inputs[input].data() + start, outputs[input].data() + start, (unsigned)length);
+            start += length;
+        }
+    }
+    return outputs;
+}
+
+static bool writeReference(const File& file, const TestCase& testCase, const std::array<std::vector<float>, 2>& outputs)
+{
+    MemoryOutputStream stream;
+    stream.writeInt(FileMagic);
+    stream.writeInt(FileVersion);
+    stream.writeInt((int)testCase.dimension);
+    for (auto &it : testCase.powers)
+        stream.writeInt(it);
+    stream.writeFloat(DecayTime);
+    stream.writeDouble(SampleRate);
+    stream.writeInt(Length);
+    for (auto &it : outputs)
+        stream.write(it.data(), it.size() * sizeof(float)); // the native (little-endian) order, like the IR cache
+    return file.replaceWithData(stream.getData(), stream.getDataSize());
+}
+
+static bool readReference(const File& file, const TestCase& testCase, std::array<std::vector<float>, 2>& outputs)
+{
+    MemoryBlock block;
+    if (! file.loadFileAsData(block))
+        return false;
+
+    // a reference of other settings is as good as a missing one
+    MemoryInputStream stream (block, false);
+    if (stream.readInt() != FileMagic || stream.readInt() != FileVersion || stream.readInt() != (int)testCase.dimension)
+        return false;
+    for (auto &it : testCase.powers)
+        if (stream.readInt() != it)
+            return false;
+    if (stream.readFloat() != DecayTime || stream.readDouble() != SampleRate || stream.readInt() != Length
+        || stream.getNumBytesRemaining() != (int64)(2 * Length * sizeof(float)))
+        return false;
+
+    for (auto &it : outputs)
+    {
+        it.resize(Length);
+        stream.read(it.data(), Length * (int)sizeof(float));
+    }
+    return true;
+}
+
+static int generate(const File& directory)
+{
+    directory.createDirectory();
+    for (auto &testCase : getTestCases())
+    {
+        auto file = getReferenceFile(directory, testCase);
+        if (! writeReference(file, testCase, renderReference(testCase)))
+        {
+            std::cerr << "Cannot write " << file.getFullPathName() << std::endl;
+            return 1;
+        }
+        std::cout << "Written " << file.getFullPathName() << std::endl;
+    }
+    return 0;
+}
+
+// the largest difference of the lanes from the reference of their input (the even lanes get the impulse)
+static float renderAndCompare(int engineIdx, const TestCase& testCase, int numLanes, const std::array<std::vector<float>, 2>& reference)
+{
+    auto inputs = createInputs();
+    auto engine = EngineRegistry::Create(engineIdx, testCase.dimension, testCase.powers, numLanes);
+    engine->Prepare(SampleRate, MaxBlockLength);
+    engine->SetDecayTime(DecayTime, SampleRate);
+
+    std::vector<std::vector<float>> outputs ((size_t)numLanes, std::vector<float>(Length));
+    const float* inputPointers[BatchReverberator::MaxLanes] = {};
+    float* outputPointers[BatchReverberator::MaxLanes] = {};
+    for (auto start = 0, blockIdx = 0; start < Length; ++blockIdx)
+    {
+        auto length = jmin(BlockLengths[blockIdx % numElementsInArray(BlockLengths)], Length - start);
+        for (auto lane = 0; lane < numLanes; ++lane)
+        {
+            inputPointers[lane] = inputs[(size_t)lane % 2].data() + start;
+            outputPointers[lane] = outputs[(size_t)lane].data() + start;
+        }
+        engine->Reverberate(inputPointers, outputPointers, (unsigned)length);
+        start += length;
+    }
+
+    auto maxDifference = 0.f;
+    for (auto lane = 0; lane < numLanes; ++lane)
+        for (auto n = 0; n < Length; ++n)
+            maxDifference = jmax(maxDifference, std::abs(outputs[(size_t)lane][(size_t)n] - reference[(size_t)lane % 2][(size_t)n]));
+    return maxDifference;
+}
+
+static bool loadReference(const File& directory, const TestCase& testCase, std::array<std::vector<float>, 2>& reference)
+{
+    if (readReference(getReferenceFile(directory, testCase), testCase, reference))
+        return true;
+    std::cout << "No reference " << getReferenceFile(directory, testCase).getFullPathName()
+              << " for these settings, run with --generate" << std::endl;
+    return false;
+}
+
+// the reference engine has to reproduce the files, otherwise they are older than the Reverberator
+static int checkReferences(const File& directory, float tolerance)
+{
+    auto failures = 0;
+    auto engineIdx = EngineRegistry::GetNames().indexOf(ReferenceEngine);
+    for (auto &testCase : getTestCases())
+    {
+        std::array<std::vector<float>, 2> reference;
+        if (! loadReference(directory, testCase, reference))
+        {
+            ++failures;
+            continue;
+        }
+
+        auto difference = renderAndCompare(engineIdx, testCase, 2, reference);
+        auto passed = difference <= tolerance;
+        if (! passed)
+            ++failures;
+        std::cout << "reference " << ReferenceEngine << " d" << (int)testCase.dimension << " " << testCase.setName
+                  << ": max difference " << difference << (passed ? "" : "  OUT OF DATE, run with --generate") << std::endl;
+    }
+    return failures > 0 ? 1 : 0;
+}
+
+static int runLevel(const String& isa, const File& directory, float tolerance)
+{
+    // the kernels are selected once per process at the first use, the level is forced before that
+   #if JUCE_WINDOWS
+    _putenv_s("FDN_ISA_LEVEL", isa.toRawUTF8());
+   #else
+    setenv("FDN_ISA_LEVEL", isa.toRawUTF8(), 1);
+   #endif
+    auto selected = String(DspKernels::getIsaName(DspKernels::getSelectedLevel()));
+    if (selected != isa)
+    {
+        std::cout << isa << ": skipped, not available (the kernels are " << selected << ")" << std::endl;
+        return 0;
+    }
+    std::cout << "DSP kernels: " << selected << std::endl;
+
+    auto failures = 0;
+    auto engines = EngineRegistry::GetNames();
+    for (auto &testCase : getTestCases())
+    {
+        std::array<std::vector<float>, 2> reference;
+        if (! loadReference(directory, testCase, reference))
+        {
+            ++failures;
+            continue;
+        }
+
+        for (auto engineIdx = 0; engineIdx < engines.size(); ++engineIdx)
+        {
+            if (engines[engineIdx] == ReferenceEngine)
+                continue;
+
+            for (auto numLanes : LaneCounts)
+            {
+                auto difference = renderAndCompare(engineIdx, testCase, numLanes, reference);
+                auto passed = difference <= tolerance;
+                if (! passed)
+                    ++failures;
+                std::cout << isa << " " << engines[engineIdx] << " d" << (int)testCase.dimension << " " << testCase.setName
+                          << " lanes " << numLanes << ": max difference " << difference << (passed ? "" : "  FAILED") << std::endl;
+            }
+        }
+    }
+    return failures > 0 ? 1 : 0;
+}
+
+int main (int argc, char* argv[])
+{
+    StringArray args;
+    for (auto i = 1; i < argc; ++i)
+        args.add(argv[i]);
+
+    auto directory = File::getCurrentWorkingDirectory().getChildFile(getOption(args, "--references", "References"));
+    auto tolerance = getOption(args, "--tolerance", "1e-5").getFloatValue();
+
+    if (args.contains("--generate"))
+        return generate(directory);
+
+    if (args.contains("--isa"))
+        return runLevel(getOption(args, "--isa", "generic"), directory, tolerance);
+
+    // every level in a process of its own
+    auto result = checkReferences(directory, tolerance);
+    for (auto level : { DspKernels::IsaLevel::generic, DspKernels::IsaLevel::sse42, DspKernels::IsaLevel::avx2, DspKernels::IsaLevel::avx512 })
+    {
+        ChildProcess child;
+        StringArray childArgs { File::getSpecialLocation(File::currentExecutableFile).getFullPathName(),
+                                "--isa", DspKernels::getIsaName(level),
+                                "--references", directory.getFullPathName(),
+                                "--tolerance", String(tolerance) };
+        if (! child.start(childArgs))
+        {
+            std::cerr << "Cannot start " << childArgs[0] << std::endl;
+            return 1;
+        }
+        std::cout << child.readAllProcessOutput();
+        if (child.getExitCode() != 0)
+            result = 1;
+    }
+    std::cout << (result == 0 ? "All the engines match the references" : "Mismatches found") << std::endl;
+    return result;
+}
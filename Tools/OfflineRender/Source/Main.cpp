@@ -0,0 +1,99 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 26 Oct 2026 2:41:06pm
+    Author:  Ekaterina Poklonskaya
+
+    Offline render of the wet signal of one long file on all the cores (see ParallelRenderer).
+    Every channel goes through its own network, the output is a 32-bit float WAV file.
+    --verify renders every channel sequentially as well and prints the largest difference.
+    Usage: OfflineRender --input in.wav --output out.wav [--dimension 2|4|8|16] [--powers 1,2,3,4]
+                         [--decay-time 2.0] [--segment-seconds 30] [--threads N] [--verify]
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "../../../Source/ParallelRenderer.h"
+
+static String getOption(const StringArray& args, const String& name, const String& defaultValue)
+{
+    auto idx = args.indexOf(name);
+    return (idx >= 0 && idx + 1 < args.size()) ? args[idx + 1] : defaultValue;
+}
+
+int main (int argc, char* argv[])
+{
+    StringArray args;
+    for (auto i = 1; i < argc; ++i)
+        args.add(argv[i]);
+
+    auto dim = getOption(args, "--dimension", "4").getIntValue();
+    std::vector<int> powers;
+    for (auto &it : StringArray::fromTokens(getOption(args, "--powers", "1,2,3,4"), ",", ""))
+        powers.push_back(it.getIntValue());
+    if ((dim != 2 && dim != 4 && dim != 8 && dim != 16) || powers.size() != (size_t)dim)
+    {
+        std::cerr << "The dimension has to be 2, 4, 8 or 16 with as many powers" << std::endl;
+        return 1;
+    }
+
+    auto inputFile = File::getCurrentWorkingDirectory().getChildFile(getOption(args, "--input", ""));
+    AudioFormatManager formats;
+    formats.registerBasicFormats();
+    std::unique_ptr<AudioFormatReader> reader (formats.createReaderFor(inputFile));
+    if (reader == nullptr)
+    {
+        std::cerr << "Cannot read " << inputFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    auto numChannels = (int)reader->numChannels;
+    auto numSamples = (int)reader->lengthInSamples;
+    AudioBuffer<float> input (numChannels, numSamples);
+    reader->read(&input, 0, numSamples, 0, true, true);
+    AudioBuffer<float> output (numChannels, numSamples);
+
+    ParallelRenderer::Settings settings;
+    settings.sampleRate = reader->sampleRate;
+    settings.decayTime = getOption(args, "--decay-time", "2").getFloatValue();
+    settings.segmentSeconds = getOption(args, "--segment-seconds", "30").getDoubleValue();
+    settings.numThreads = getOption(args, "--threads", "0").getIntValue();
+    ParallelRenderer renderer ((Reverberator::FdnDimension)dim, powers, settings);
+
+    auto startTime = Time::getMillisecondCounterHiRes();
+    for (auto channel = 0; channel < numChannels; ++channel)
+        renderer.render(input.getReadPointer(channel), output.getWritePointer(channel), numSamples);
+    auto elapsedSeconds = (Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+    std::cout << numChannels << " x " << numSamples << " samples in " << renderer.getNumSegments(numSamples) << " segments, "
+              << elapsedSeconds << " s, " << numSamples / reader->sampleRate / elapsedSeconds << " x realtime" << std::endl;
+
+    if (args.contains("--verify"))
+    {
+        std::vector<float> reference ((size_t)numSamples);
+        auto maxDifference = 0.f;
+        for (auto channel = 0; channel < numChannels; ++channel)
+        {
+            Reverberator reverberator ((Reverberator::FdnDimension)dim, powers);
+            reverberator.SetDecayTime(settings.decayTime, settings.sampleRate);
+            reverberator.Reverberate(input.getReadPointer(channel), reference.data(), (unsigned)numSamples);
+            for (auto n = 0; n < numSamples; ++n)
+                maxDifference = jmax(maxDifference, std::abs(reference[n] - output.getSample(channel, n)));
+        }
+        std::cout << "largest difference from the sequential render " << maxDifference
+                  << " (" << Decibels::gainToDecibels(maxDifference) << " dB)" << std::endl;
+    }
+
+    auto outputFile = File::getCurrentWorkingDirectory().getChildFile(getOption(args, "--output", "out.wav"));
+    outputFile.deleteFile();
+    WavAudioFormat wav;
+    std::unique_ptr<AudioFormatWriter> writer (wav.createWriterFor(new FileOutputStream(outputFile), reader->sampleRate,
+                                                                   (unsigned)numChannels, 32, {}, 0));
+    if (writer == nullptr || ! writer->writeFromAudioSampleBuffer(output, 0, numSamples))
+    {
+        std::cerr << "Cannot write " << outputFile.getFullPathName() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,246 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 23 Oct 2026 5:21:08pm
+    Author:  Ekaterina Poklonskaya
+
+    Headless many-instance benchmark of the plugin processor.
+    Creates M processors with mixed dimensions and calls processBlock on them round-robin,
+    the way a host does, for every M of the list and every engine of the EngineRegistry (or of --engines).
+    --pipelined renders every instance on its own helper thread.
+    Usage: ScalingHarness [--instances 1,2,4,...] [--dimensions 4,8,16] [--engines Batch,Scalar] [--block 256]
+                          [--rate 48000] [--seconds 5] [--seed 1] [--pipelined]
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "../../../Source/PluginProcessor.h"
+#include "random"
+
+#if JUCE_LINUX
+ #include <linux/perf_event.h>
+ #include <sys/ioctl.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+#elif JUCE_MAC
+ #include <mach/mach.h>
+#endif
+
+// last level cache references and misses of this process, read with perf_event_open (Linux only)
+class CacheCounters
+{
+public:
+    CacheCounters()
+    {
+       #if JUCE_LINUX
+        references = open(PERF_COUNT_HW_CACHE_REFERENCES, -1);
+        misses = open(PERF_COUNT_HW_CACHE_MISSES, references);
+       #endif
+    }
+
+    ~CacheCounters()
+    {
+       #if JUCE_LINUX
+        if (misses >= 0)
+            close(misses);
+        if (references >= 0)
+            close(references);
+       #endif
+    }
+
+    bool isAvailable() const
+    {
+        return references >= 0 && misses >= 0;
+    }
+
+    void start()
+    {
+       #if JUCE_LINUX
+        if (! isAvailable())
+            return;
+        ioctl(references, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(references, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+       #endif
+    }
+
+    // references and misses since start()
+    std::pair<uint64, uint64> stop()
+    {
+        uint64 referencesCount = 0, missesCount = 0;
+       #if JUCE_LINUX
+        if (isAvailable())
+        {
+            ioctl(references, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+            if (read(references, &referencesCount, sizeof(referencesCount)) != sizeof(referencesCount)
+                || read(misses, &missesCount, sizeof(missesCount)) != sizeof(missesCount))
+                referencesCount = missesCount = 0;
+        }
+       #endif
+        return std::make_pair(referencesCount, missesCount);
+    }
+
+private:
+   #if JUCE_LINUX
+    static int open(uint64 config, int groupFd)
+    {
+        perf_event_attr attributes {};
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.size = sizeof(attributes);
+        attributes.config = config;
+        attributes.disabled = (groupFd < 0) ? 1 : 0;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        return (int)syscall(__NR_perf_event_open, &attributes, 0, -1, groupFd, 0);
+    }
+   #endif
+
+    int references = -1;
+    int misses = -1;
+};
+
+static double getResidentMegabytes()
+{
+   #if JUCE_LINUX
+    // the second field of statm is the resident set in pages
+    auto fields = StringArray::fromTokens(File("/proc/self/statm").loadFileAsString(), true);
+    return fields[1].getLargeIntValue() * (double)sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0);
+   #elif JUCE_MAC
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS)
+        return 0.0;
+    return info.resident_size / (1024.0 * 1024.0);
+   #else
+    return 0.0;
+   #endif
+}
+
+static String getOption(const StringArray& args, const String& name, const String& defaultValue)
+{
+    auto idx = args.indexOf(name);
+    return (idx >= 0 && idx + 1 < args.size()) ? args[idx + 1] : defaultValue;
+}
+
+static Array<int> getIntList(const String& list)
+{
+    Array<int> values;
+    for (auto &it : StringArray::fromTokens(list, ",", {}))
+        values.add(it.getIntValue());
+    return values;
+}
+
+struct Instance
+{
+    std::unique_ptr<FdnReverberationNewAudioProcessor> processor;
+    AudioBuffer<float> buffer;
+};
+
+int main (int argc, char* argv[])
+{
+    StringArray args;
+    for (auto i = 1; i < argc; ++i)
+        args.add(argv[i]);
+
+    auto instanceCounts = getIntList(getOption(args, "--instances", "1,2,4,8,16,32,64,128,256"));
+    auto dimensions = getIntList(getOption(args, "--dimensions", "4,8,16"));
+    auto blockLength = getOption(args, "--block", "256").getIntValue();
+    auto sampleRate = getOption(args, "--rate", "48000").getDoubleValue();
+    auto seconds = getOption(args, "--seconds", "5").getDoubleValue();
+    auto seed = (uint32)getOption(args, "--seed", "1").getIntValue();
+    auto pipelined = args.contains("--pipelined");
+    auto engines = StringArray::fromTokens(getOption(args, "--engines", EngineRegistry::GetNames().joinIntoString(",")), ",", {});
+
+    for (auto dim : dimensions)
+    {
+        if (dim != 2 && dim != 4 && dim != 8 && dim != 16)
+        {
+            std::cerr << "The dimensions have to be 2, 4, 8 or 16" << std::endl;
+            return 1;
+        }
+    }
+    for (auto &it : engines)
+    {
+        if (! EngineRegistry::GetNames().contains(it))
+        {
+            std::cerr << "Unknown engine " << it << ", the engines are " << EngineRegistry::GetNames().joinIntoString(", ") << std::endl;
+            return 1;
+        }
+    }
+
+    CacheCounters counters;
+    if (! counters.isAvailable())
+        std::cout << "LLC counters are not available, the miss rate is not reported" << std::endl;
+
+    std::cout << "engine\tinstances\trealtime x\tus/block/instance\tdeadline %\tRSS MB\tLLC misses/block\tLLC miss rate" << std::endl;
+
+    auto numBlocks = jmax(1, (int)(seconds * sampleRate / blockLength));
+    auto blockSeconds = blockLength / sampleRate;
+    auto baseMemory = getResidentMegabytes();
+
+    for (auto &engine : engines)
+    {
+        for (auto numInstances : instanceCounts)
+        {
+            // the same presets for every engine
+            std::mt19937 random (seed + (uint32)numInstances);
+            std::vector<Instance> instances ((size_t)numInstances);
+            for (auto i = 0; i < numInstances; ++i)
+            {
+                // the dimensions go round the list, the powers are random, like a session with many different presets
+                auto dim = dimensions[i % dimensions.size()];
+                std::vector<int> powers ((size_t)dim);
+                for (auto line = 0; line < dim; ++line)
+                    powers[line] = 1 + (int)(random() % (uint32)Reverberator::GetMaxPower(line));
+
+                auto& instance = instances[i];
+                instance.processor.reset(new FdnReverberationNewAudioProcessor());
+                instance.processor->setPlayConfigDetails(2, 2, sampleRate, blockLength);
+                instance.processor->setDimension((Reverberator::FdnDimension)dim);
+                instance.processor->setDelayPowers(powers);
+                if (pipelined)
+                    instance.processor->getParameters().getParameter("pipelined")->setValueNotifyingHost(1.0f);
+                auto* engineParameter = instance.processor->getParameters().getParameter("engine");
+                engineParameter->setValueNotifyingHost(engineParameter->convertTo0to1((float)EngineRegistry::GetNames().indexOf(engine)));
+                instance.processor->prepareToPlay(sampleRate, blockLength);
+                instance.buffer.setSize(2, blockLength);
+            }
+
+            MidiBuffer midi;
+            auto processAll = [&]()
+            {
+                for (auto &it : instances)
+                {
+                    for (auto channel = 0; channel < 2; ++channel)
+                        for (auto n = 0; n < blockLength; ++n)
+                            it.buffer.setSample(channel, n, (n & 1) ? 0.1f : -0.1f);
+                    it.processor->processBlock(it.buffer, midi);
+                }
+            };
+
+            // one second of warm-up, so the delay memory of every instance has been touched
+            for (auto block = 0; block < (int)(sampleRate / blockLength); ++block)
+                processAll();
+
+            counters.start();
+            auto startTime = Time::getHighResolutionTicks();
+            for (auto block = 0; block < numBlocks; ++block)
+                processAll();
+            auto elapsedSeconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTime);
+            auto cacheCounts = counters.stop();
+
+            auto secondsPerRound = elapsedSeconds / numBlocks;
+            std::cout << engine << "\t" << numInstances
+                      << "\t" << String(numInstances * blockSeconds / secondsPerRound, 1)
+                      << "\t" << String(secondsPerRound / numInstances * 1.0e6, 2)
+                      << "\t" << String(100.0 * secondsPerRound / blockSeconds, 1)
+                      << "\t" << String(getResidentMegabytes() - baseMemory, 1);
+            if (counters.isAvailable())
+                std::cout << "\t" << String((double)cacheCounts.second / numBlocks, 0)
+                          << "\t" << String(cacheCounts.first > 0 ? 100.0 * cacheCounts.second / cacheCounts.first : 0.0, 1) << "%";
+            std::cout << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,18 @@
+#!/bin/sh
+# The headless tests of the plugin: builds Tools/GoldenTest with the Projucer's Linux Makefile and runs it
+# on the stored references. Exits with the test's code, 1 on a mismatch.
+# PROJUCER points to the Projucer binary if it is not on the PATH, CONFIG picks Debug or Release (default).
+# Extra arguments go to the test, e.g. Tools/run_tests.sh --tolerance 1e-6
+
+set -e
+cd "$(dirname "$0")/GoldenTest"
+
+PROJUCER="${PROJUCER:-Projucer}"
+CONFIG="${CONFIG:-Release}"
+
+# the Makefile is generated, resave it so it follows the .jucer
+"$PROJUCER" --resave GoldenTest.jucer
+make -C Builds/LinuxMakefile CONFIG="$CONFIG" -j"$(nproc)"
+
+# the references are looked up relative to the working directory
+exec ./Builds/LinuxMakefile/build/GoldenTest "$@"